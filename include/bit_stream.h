@@ -0,0 +1,194 @@
+// Copyright (c) 2020-2024, Brandon Lehmann
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef SERIALIZATION_BIT_STREAM_H
+#define SERIALIZATION_BIT_STREAM_H
+
+#include <deserializer_t.h>
+#include <serializer_t.h>
+
+namespace Serialization
+{
+    /**
+     * Writes values of arbitrary bit widths to a serializer_t, least significant bit first, collecting
+     * them in a 64-bit accumulator that is appended to the writer a word at a time
+     *
+     * Note: Bits are only appended to the writer as whole words or when flushed; the final partial byte
+     * is padded with zero bits. Nothing else should be written to the writer until the bit writer has
+     * been flushed (which also happens when it is destroyed).
+     */
+    struct bit_writer_t final
+    {
+        explicit bit_writer_t(serializer_t &writer);
+
+        ~bit_writer_t();
+
+        bit_writer_t(const bit_writer_t &) = delete;
+
+        bit_writer_t &operator=(const bit_writer_t &) = delete;
+
+        /**
+         * Writes the lowest count bits (at most 64) of the value
+         *
+         * @param value
+         * @param count
+         */
+        void bits(uint64_t value, uint8_t count)
+        {
+            // fast path: the bits fit within the accumulator
+            if (count < 64 && used + count < 64)
+            {
+                accumulator |= (value & ((uint64_t(1) << count) - 1)) << used;
+
+                used += count;
+
+                return;
+            }
+
+            spill(value, count);
+        }
+
+        /**
+         * Writes the value as a single bit
+         *
+         * @param value
+         */
+        void flag(bool value)
+        {
+            bits(value ? 1 : 0, 1);
+        }
+
+        /**
+         * Writes each of the values as a single bit, without a length prefix
+         *
+         * @param values
+         */
+        void flags(const std::vector<bool> &values);
+
+        /**
+         * Appends any bits that have not yet been written to the writer, padding the final byte with zero bits
+         */
+        void flush();
+
+      private:
+        /**
+         * Writes the bits of the value that overflow the accumulator, appending the full accumulator
+         * to the writer
+         */
+        void spill(uint64_t value, uint8_t count);
+
+        serializer_t &writer;
+
+        uint64_t accumulator = 0;
+
+        uint8_t used = 0;
+    };
+
+    /**
+     * Reads values written by a bit_writer_t from a deserializer_t, loading the bytes of the reader up
+     * to 64 bits at a time into an accumulator
+     *
+     * Note: The reader is advanced past the bytes as they are loaded; align() (which also happens when the
+     * bit reader is destroyed) discards the rest of the current byte and returns any whole bytes that were
+     * loaded but not consumed to the reader. Nothing else should be read from the reader until then.
+     */
+    struct bit_reader_t final
+    {
+        explicit bit_reader_t(deserializer_t &reader);
+
+        ~bit_reader_t();
+
+        bit_reader_t(const bit_reader_t &) = delete;
+
+        bit_reader_t &operator=(const bit_reader_t &) = delete;
+
+        /**
+         * Discards the remaining bits of the current byte such that the reader is positioned at the
+         * first byte following the bit stream
+         */
+        void align();
+
+        /**
+         * Reads a value of count bits (at most 64)
+         *
+         * @param count
+         * @return
+         */
+        uint64_t bits(uint8_t count)
+        {
+            // fast path: the bits are already held in the accumulator
+            if (count < 64 && count <= available)
+            {
+                const auto result = accumulator & ((uint64_t(1) << count) - 1);
+
+                accumulator >>= count;
+
+                available -= count;
+
+                return result;
+            }
+
+            return fill(count);
+        }
+
+        /**
+         * Reads a single bit
+         *
+         * @return
+         */
+        bool flag()
+        {
+            return bits(1) != 0;
+        }
+
+        /**
+         * Reads the given number of single bit values
+         *
+         * @param count
+         * @return
+         */
+        std::vector<bool> flags(size_t count);
+
+      private:
+        /**
+         * Reads a value of count bits that extends beyond the bits held in the accumulator
+         */
+        uint64_t fill(uint8_t count);
+
+        /**
+         * Loads up to the next eight bytes of the reader into the (empty) accumulator
+         */
+        void refill();
+
+        deserializer_t &reader;
+
+        uint64_t accumulator = 0;
+
+        uint8_t available = 0;
+    };
+} // namespace Serialization
+
+#endif
@@ -0,0 +1,102 @@
+// Copyright (c) 2020-2024, Brandon Lehmann
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef SERIALIZATION_BITPACKING_H
+#define SERIALIZATION_BITPACKING_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * The number of values held in each bit-packed block
+ */
+#define BITPACKING_BLOCK_SIZE 128
+
+namespace Serialization
+{
+    /**
+     * Kernels that pack blocks of BITPACKING_BLOCK_SIZE 32-bit values into the minimum number of
+     * bits per value and back again
+     *
+     * Note: Values are interleaved across four 32-bit lanes (value i lives in lane i % 4) so that
+     * each step of the kernels processes four values at once with a single vector instruction
+     */
+    namespace BitPacking
+    {
+        /**
+         * Packs a block of values, each of which must fit within the given width, into the output,
+         * which must have room for packed_size(width) bytes
+         *
+         * @param values
+         * @param width
+         * @param output
+         */
+        void pack(const uint32_t *values, uint8_t width, unsigned char *output);
+
+        /**
+         * Returns the number of bytes a block packed at the given width occupies
+         *
+         * @param width
+         * @return
+         */
+        inline size_t packed_size(uint8_t width)
+        {
+            return (BITPACKING_BLOCK_SIZE / 8) * width;
+        }
+
+        /**
+         * Unpacks a block of values of the given width from the input, which must hold at least
+         * packed_size(width) bytes
+         *
+         * @param input
+         * @param width
+         * @param values
+         */
+        void unpack(const unsigned char *input, uint8_t width, uint32_t *values);
+
+        /**
+         * Returns the number of bits required to represent the value
+         *
+         * @param value
+         * @return
+         */
+        inline uint8_t width(uint64_t value)
+        {
+            uint8_t bits = 0;
+
+            while (value != 0)
+            {
+                bits++;
+
+                value >>= 1;
+            }
+
+            return bits;
+        }
+    } // namespace BitPacking
+} // namespace Serialization
+
+#endif
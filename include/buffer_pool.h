@@ -0,0 +1,123 @@
+// Copyright (c) 2020-2024, Brandon Lehmann
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef SERIALIZATION_BUFFER_POOL_H
+#define SERIALIZATION_BUFFER_POOL_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+namespace Serialization
+{
+    /**
+     * Counters describing the activity of the buffer pool of the calling thread
+     */
+    struct buffer_pool_stats_t
+    {
+        /**
+         * Returns the fraction of acquisitions that were satisfied from the pool
+         *
+         * @return
+         */
+        [[nodiscard]] double hit_rate() const
+        {
+            return (hits + misses == 0) ? 0.0 : double(hits) / double(hits + misses);
+        }
+
+        size_t hits = 0;
+
+        size_t misses = 0;
+
+        size_t released = 0;
+
+        size_t discarded = 0;
+
+        size_t retained_buffers = 0;
+
+        size_t retained_bytes = 0;
+    };
+
+    /**
+     * Thread-local free lists of byte vectors, bucketed by power of two capacity, that allow
+     * serializer_t instances to recycle their buffers instead of allocating fresh ones
+     *
+     * Note: Pooling is opt-in and process-wide; once enabled, every default constructed
+     * serializer_t draws its buffer from the pool of the constructing thread and returns
+     * it to the pool of the destroying thread
+     */
+    namespace BufferPool
+    {
+        /**
+         * Acquires an empty buffer with at least the given capacity from the pool of the calling thread
+         *
+         * @param capacity
+         * @return
+         */
+        std::pmr::vector<unsigned char> acquire(size_t capacity = 0);
+
+        /**
+         * Frees all buffers retained by the pool of the calling thread
+         */
+        void clear();
+
+        /**
+         * Enables (or disables) the use of the pool by serializer_t
+         *
+         * @param value
+         */
+        void enable(bool value = true);
+
+        /**
+         * Returns whether serializer_t draws its buffers from the pool
+         *
+         * @return
+         */
+        [[nodiscard]] bool enabled();
+
+        /**
+         * Returns the buffer to the pool of the calling thread; buffers that are too large, or that
+         * would exceed the number of buffers retained for their capacity, are freed instead
+         *
+         * @param buffer
+         */
+        void release(std::pmr::vector<unsigned char> &&buffer);
+
+        /**
+         * Resets the counters of the pool of the calling thread
+         */
+        void reset_stats();
+
+        /**
+         * Returns the counters of the pool of the calling thread
+         *
+         * @return
+         */
+        [[nodiscard]] buffer_pool_stats_t stats();
+    } // namespace BufferPool
+} // namespace Serialization
+
+#endif
@@ -0,0 +1,70 @@
+// Copyright (c) 2020-2024, Brandon Lehmann
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef SERIALIZATION_BYTE_ORDER_H
+#define SERIALIZATION_BYTE_ORDER_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Serialization
+{
+    /**
+     * Kernels that convert arrays of fixed width integers between host byte order and little or big
+     * endian byte order
+     *
+     * Note: When the requested byte order matches the host, the conversion is a plain memcpy; otherwise
+     * the bytes of each value are reversed sixteen bytes at a time with vector instructions
+     */
+    namespace ByteOrder
+    {
+        /**
+         * Copies the given number of values of the given width (2, 4 or 8 bytes) from the input to the
+         * output, converting between host byte order and the requested byte order (the conversion is
+         * its own inverse, so the same call serves both reading and writing)
+         *
+         * @param input
+         * @param output
+         * @param count
+         * @param width
+         * @param big_endian
+         */
+        void copy(const void *input, void *output, size_t count, size_t width, bool big_endian);
+
+        /**
+         * Copies the given number of values of the given width (2, 4 or 8 bytes) from the input to the
+         * output, reversing the bytes of each value
+         *
+         * @param input
+         * @param output
+         * @param count
+         * @param width
+         */
+        void swap(const void *input, void *output, size_t count, size_t width);
+    } // namespace ByteOrder
+} // namespace Serialization
+
+#endif
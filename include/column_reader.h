@@ -0,0 +1,207 @@
+// Copyright (c) 2020-2024, Brandon Lehmann
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef SERIALIZATION_COLUMN_READER_H
+#define SERIALIZATION_COLUMN_READER_H
+
+#include <deserializer_t.h>
+
+namespace Serialization
+{
+    /**
+     * Reads a vector of records stored as columns (as written by serializer_t::columns) such that only the
+     * columns that are needed have to be decoded
+     *
+     * Note: Each column must be decoded as the same field type that it was written with. The reader refers
+     * to the bytes of the reader it was created from (which are reference counted) rather than copying them.
+     */
+    struct column_reader_t final
+    {
+        /**
+         * Reads the column table from the reader, advancing the reader past every column
+         *
+         * @param reader
+         */
+        explicit column_reader_t(deserializer_t &reader);
+
+        /**
+         * Decodes the column at the given index as the values of a field
+         *
+         * @tparam Field
+         * @param index
+         * @return
+         */
+        template<typename Field> std::vector<Field> column(size_t index) const
+        {
+            std::vector<Field> result;
+
+            column(index, result);
+
+            return result;
+        }
+
+        /**
+         * Decodes the column at the given index into the supplied vector, reusing its existing elements
+         * and capacity
+         *
+         * @tparam Field
+         * @param index
+         * @param result
+         */
+        template<typename Field, typename Allocator>
+        void column(size_t index, std::vector<Field, Allocator> &result) const
+        {
+            auto reader = slice(index);
+
+            if constexpr (std::is_same_v<Field, bool>)
+            {
+                const auto values = reader.booleanV();
+
+                result.assign(values.begin(), values.end());
+            }
+            else if constexpr (std::is_integral_v<Field>)
+            {
+                if constexpr (std::is_signed_v<Field>)
+                {
+                    const auto values = reader.bitpackedV<std::make_unsigned_t<Field>>();
+
+                    result.resize(values.size());
+
+                    for (size_t i = 0; i < values.size(); ++i)
+                    {
+                        result[i] = zigzag_decode<Field>(values[i]);
+                    }
+                }
+                else
+                {
+                    reader.bitpackedV(result);
+                }
+            }
+            else if constexpr (std::is_trivially_copyable_v<Field>)
+            {
+                result.resize(reader.size() / sizeof(Field));
+
+                reader.bytes(result.data(), result.size() * sizeof(Field));
+            }
+            else
+            {
+                const auto width = Field().size();
+
+                // refuse counts that cannot possibly be satisfied before allocating for them, dividing rather
+                // than multiplying so that a hostile count cannot wrap the product
+                if (width == 0 ? count != 0 : count > reader.size() / width)
+                {
+                    throw std::range_error("column " + std::to_string(index) + " does not match the record count");
+                }
+
+                result.resize(count);
+
+                for (auto &value : result)
+                {
+                    value = reader.template pod<Field>();
+                }
+            }
+
+            if (result.size() != count || reader.unread_bytes() != 0)
+            {
+                throw std::range_error("column " + std::to_string(index) + " does not match the record count");
+            }
+        }
+
+        /**
+         * Decodes the column at the given index into the given field of each of the supplied records,
+         * resizing the vector of records to the record count if necessary
+         *
+         * @tparam Record
+         * @tparam Field
+         * @param index
+         * @param records
+         * @param field
+         */
+        template<typename Record, typename Allocator, typename Field>
+        void column(size_t index, std::vector<Record, Allocator> &records, Field Record::*field) const
+        {
+            const auto values = column<Field>(index);
+
+            records.resize(count);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                records[i].*field = values[i];
+            }
+        }
+
+        /**
+         * Returns the number of columns
+         *
+         * @return
+         */
+        [[nodiscard]] size_t columns() const;
+
+        /**
+         * Decodes the records from the leading columns, one given field per column in column order
+         *
+         * Note: The vector of records is only resized once the first column has been decoded and found
+         * to hold the record count, so an untrusted record count is never allocated for on its own
+         *
+         * @tparam Record
+         * @tparam Fields
+         * @param result
+         * @param fields
+         */
+        template<typename Record, typename Allocator, typename... Fields>
+        void records(std::vector<Record, Allocator> &result, Fields Record::*...fields) const
+        {
+            static_assert(sizeof...(Fields) != 0, "at least one column is required");
+
+            size_t index = 0;
+
+            (column(index++, result, fields), ...);
+        }
+
+        /**
+         * Returns the number of records
+         *
+         * @return
+         */
+        [[nodiscard]] size_t size() const;
+
+      private:
+        /**
+         * Returns a reader over the column at the given index
+         *
+         * @param index
+         * @return
+         */
+        [[nodiscard]] deserializer_t slice(size_t index) const;
+
+        size_t count = 0;
+
+        std::vector<deserializer_t> slices;
+    };
+} // namespace Serialization
+
+#endif
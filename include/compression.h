@@ -0,0 +1,157 @@
+// Copyright (c) 2020-2024, Brandon Lehmann
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef SERIALIZATION_COMPRESSION_H
+#define SERIALIZATION_COMPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * The default number of uncompressed bytes held in each compressed chunk
+ */
+#define COMPRESSION_CHUNK_SIZE 65536
+
+namespace Serialization
+{
+    struct rope_deserializer_t;
+
+    /**
+     * A self-contained LZ77 family block codec (using the LZ4 block layout: a token holding the literal and
+     * match lengths, the literals, a 16-bit match offset and any length extension bytes) that favours
+     * speed over ratio
+     *
+     * A compressed stream, as produced by serializer_t::compressed(), is a series of independently
+     * decodable chunks, each prefixed by its uncompressed and stored lengths as little-endian uint32s
+     * (equal lengths mean the chunk is stored uncompressed), and terminated by a chunk of zero length.
+     */
+    namespace Compression
+    {
+        /**
+         * Returns the maximum number of bytes that compressing the given number of bytes can produce
+         *
+         * @param length
+         * @return
+         */
+        inline size_t bound(size_t length)
+        {
+            return length + length / 255 + 16;
+        }
+
+        /**
+         * Compresses the input into the output, which must have room for bound(length) bytes
+         *
+         * Note: The length of the input must be less than 4 GiB
+         *
+         * @param input
+         * @param length
+         * @param output
+         * @return the number of bytes written to the output
+         */
+        size_t compress(const void *input, size_t length, void *output);
+
+        /**
+         * Decompresses the input into the output, which has room for capacity bytes
+         *
+         * Note: Throws if the input is malformed or does not fit within the output
+         *
+         * @param input
+         * @param length
+         * @param output
+         * @param capacity
+         * @return the number of bytes written to the output
+         */
+        size_t decompress(const void *input, size_t length, void *output, size_t capacity);
+    } // namespace Compression
+
+    /**
+     * Decompresses a compressed stream (see serializer_t::compressed()) as it arrives, appending each
+     * chunk to a rope_deserializer_t as soon as it is complete such that values may be read before
+     * the rest of the stream has arrived and the whole payload is never held in one contiguous buffer
+     *
+     * Note: Chunks that declare more than max_chunk_size uncompressed bytes are rejected as soon as
+     * their header arrives, before any memory is committed to them, so a stream written with a larger
+     * chunk size must be read with a matching limit
+     */
+    struct decompressor_t final
+    {
+        explicit decompressor_t(rope_deserializer_t &reader, size_t max_chunk_size = COMPRESSION_CHUNK_SIZE);
+
+        /**
+         * Returns whether the end of the compressed stream has been reached
+         *
+         * @return
+         */
+        [[nodiscard]] bool finished() const;
+
+        /**
+         * Feeds the next bytes of the compressed stream to the decompressor
+         *
+         * @param data
+         * @param length
+         * @return the number of bytes consumed, which is less than the length only if the end of the
+         * compressed stream was reached
+         */
+        size_t write(const void *data, size_t length);
+
+        /**
+         * Feeds the next bytes of the compressed stream to the decompressor
+         *
+         * @param data
+         * @return the number of bytes consumed
+         */
+        size_t write(const std::vector<unsigned char> &data);
+
+      private:
+        /**
+         * Decompresses the complete chunk (including its already validated header) and appends it to the
+         * reader
+         *
+         * @param data
+         */
+        void chunk(const unsigned char *data);
+
+        /**
+         * Validates the chunk header against the limits of the decompressor and returns the number of
+         * stored bytes that follow it
+         *
+         * @param data
+         * @return
+         */
+        [[nodiscard]] uint32_t header(const unsigned char *data) const;
+
+        rope_deserializer_t &reader;
+
+        size_t max_chunk_size;
+
+        std::vector<unsigned char> pending;
+
+        bool done = false;
+    };
+} // namespace Serialization
+
+#endif
@@ -27,21 +27,173 @@
 #ifndef SERIALIZATION_DESERIALIZER_T
 #define SERIALIZATION_DESERIALIZER_T
 
+#include <bitpacking.h>
+#include <limits>
+#include <memory>
 #include <serializer_t.h>
+#include <streamvbyte.h>
 #include <string_helper.h>
 
 namespace Serialization
 {
+    /**
+     * Note: The byte vector read by a deserializer_t is never modified while it is shared,
+     * reference counted, between copies of the reader and any slices taken from it; each copy
+     * keeps its own position. As such, copying a reader is O(1) and separate copies may decode
+     * the same bytes concurrently from different threads without copying or locking. A single
+     * instance must not be used from multiple threads at once.
+     */
     struct deserializer_t final
     {
-        explicit deserializer_t(const serializer_t &writer);
+        explicit deserializer_t(
+            const serializer_t &writer,
+            std::pmr::memory_resource *resource = std::pmr::get_default_resource());
 
         deserializer_t(std::initializer_list<unsigned char> input);
 
-        explicit deserializer_t(const std::vector<unsigned char> &input);
+        explicit deserializer_t(
+            const std::vector<unsigned char> &input,
+            std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+        explicit deserializer_t(std::vector<unsigned char> &&input);
 
         explicit deserializer_t(const std::string &input);
 
+        /**
+         * Replaces the contents of the reader with the supplied data and resets its position,
+         * reusing the capacity of the existing byte vector if it is not shared with another reader
+         *
+         * @param data
+         * @param length
+         */
+        void assign(const unsigned char *data, size_t length);
+
+        /**
+         * Replaces the contents of the reader with the supplied data and resets its position,
+         * reusing the capacity of the existing byte vector if it is not shared with another reader
+         *
+         * @param data
+         */
+        void assign(const std::vector<unsigned char> &data);
+
+        /**
+         * Decodes a frame of reference bit packed vector of values from the byte vector
+         * @tparam Type
+         * @param peek
+         * @return
+         */
+        template<typename Type> std::vector<Type> bitpackedV(bool peek = false)
+        {
+            std::vector<Type> result;
+
+            bitpackedV(result, peek);
+
+            return result;
+        }
+
+        /**
+         * Decodes a frame of reference bit packed vector of values from the byte vector into the supplied
+         * vector, reusing its capacity
+         * @tparam Type
+         * @param result
+         * @param peek
+         */
+        template<typename Type, typename Allocator>
+        void bitpackedV(std::vector<Type, Allocator> &result, bool peek = false)
+        {
+            static_assert(
+                std::is_unsigned_v<Type> && sizeof(Type) <= sizeof(uint64_t),
+                "bit packing requires an unsigned integer type of at most 64 bits");
+
+            const auto start = offset;
+
+            const auto count = varint<uint64_t>();
+
+            // every block occupies at least two bytes and every trailing value at least one
+            require((count / BITPACKING_BLOCK_SIZE) * 2 + count % BITPACKING_BLOCK_SIZE);
+
+            result.resize(count);
+
+            uint32_t offsets[BITPACKING_BLOCK_SIZE];
+
+            size_t i = 0;
+
+            for (; i + BITPACKING_BLOCK_SIZE <= count; i += BITPACKING_BLOCK_SIZE)
+            {
+                const auto low = uint64_t(varint<Type>());
+
+                const auto width = uint8();
+
+                if (width == 64)
+                {
+                    for (size_t j = 0; j < BITPACKING_BLOCK_SIZE; ++j)
+                    {
+                        const auto value = low + uint64();
+
+                        if (value < low || value > std::numeric_limits<Type>::max())
+                        {
+                            throw std::range_error(
+                                "value is out of range for type at position " + std::to_string(base + offset));
+                        }
+
+                        result[i + j] = Type(value);
+                    }
+
+                    continue;
+                }
+
+                if (width > 32)
+                {
+                    throw std::range_error("invalid bit width at position " + std::to_string(base + offset - 1));
+                }
+
+                require(BitPacking::packed_size(width));
+
+                BitPacking::unpack(data() + offset, width, offsets);
+
+                offset += BitPacking::packed_size(width);
+
+                const auto output = result.data() + i;
+
+                const auto span = (uint64_t(1) << width) - 1;
+
+                // when no offset of this width can overflow the type, skip the per value check so the
+                // loop vectorizes; written as a subtraction so a uint64_t type cannot wrap the bound
+                if (span <= std::numeric_limits<Type>::max() && low <= std::numeric_limits<Type>::max() - span)
+                {
+                    for (size_t j = 0; j < BITPACKING_BLOCK_SIZE; ++j)
+                    {
+                        output[j] = Type(Type(low) + Type(offsets[j]));
+                    }
+
+                    continue;
+                }
+
+                for (size_t j = 0; j < BITPACKING_BLOCK_SIZE; ++j)
+                {
+                    const auto value = low + offsets[j];
+
+                    if (value < low || value > std::numeric_limits<Type>::max())
+                    {
+                        throw std::range_error(
+                            "value is out of range for type at position " + std::to_string(base + offset));
+                    }
+
+                    output[j] = Type(value);
+                }
+            }
+
+            for (; i < count; ++i)
+            {
+                result[i] = varint<Type>();
+            }
+
+            if (peek)
+            {
+                reset(start);
+            }
+        }
+
         /**
          * Decodes a value from the byte vector
          * @param peek
@@ -49,6 +201,13 @@ namespace Serialization
          */
         bool boolean(bool peek = false);
 
+        /**
+         * Decodes a vector of values packed one bit per value from the byte vector
+         * @param peek
+         * @return
+         */
+        std::vector<bool> booleanV(bool peek = false);
+
         /**
          * Returns a byte vector of the given length from the byte vector
          * @param count
@@ -57,6 +216,14 @@ namespace Serialization
          */
         std::vector<unsigned char> bytes(size_t count = 1, bool peek = false);
 
+        /**
+         * Copies the given number of bytes from the byte vector into the supplied output
+         * @param output
+         * @param count
+         * @param peek
+         */
+        void bytes(void *output, size_t count, bool peek = false);
+
         /**
          * Trims read dead from the byte vector thus reducing its memory footprint
          */
@@ -68,6 +235,59 @@ namespace Serialization
          */
         [[nodiscard]] const unsigned char *data() const;
 
+        /**
+         * Decodes a delta encoded vector of sorted values from the byte vector
+         * @tparam Type
+         * @param peek
+         * @return
+         */
+        template<typename Type> std::vector<Type> delta_varintV(bool peek = false)
+        {
+            std::vector<Type> result;
+
+            delta_varintV(result, peek);
+
+            return result;
+        }
+
+        /**
+         * Decodes a delta encoded vector of sorted values from the byte vector into the supplied vector,
+         * reusing its capacity
+         * @tparam Type
+         * @param result
+         * @param peek
+         */
+        template<typename Type, typename Allocator>
+        void delta_varintV(std::vector<Type, Allocator> &result, bool peek = false)
+        {
+            static_assert(std::is_unsigned_v<Type>, "delta decoding requires an unsigned integer type");
+
+            const auto start = offset;
+
+            const auto count = varint<uint64_t>();
+
+            // every element occupies at least one byte, so refuse counts that cannot possibly be satisfied
+            require(count);
+
+            result.resize(count);
+
+            try
+            {
+                offset += decode_delta_varints<Type>(data(), size(), offset, result.data(), count);
+            }
+            catch (const std::range_error &e)
+            {
+                reset(start);
+
+                throw std::range_error(std::string(e.what()) + " at position " + std::to_string(base + start));
+            }
+
+            if (peek)
+            {
+                reset(start);
+            }
+        }
+
         /**
          * Decodes a hex encoded string of the given length from the byte vector
          * @param length
@@ -77,88 +297,367 @@ namespace Serialization
         std::string hex(size_t length = 1, bool peek = false);
 
         /**
-         * Decodes a value from the byte vector
+         * Decodes a value from the byte vector
+         *
+         * @tparam Type
+         * @param peek
+         * @return
+         */
+        template<typename Type> Type pod(bool peek = false)
+        {
+            Type result;
+
+            const auto data = bytes(result.size(), peek);
+
+            result.deserialize(data);
+
+            return result;
+        }
+
+        /**
+         * Decodes a vector of values from the byte vector
+         *
+         * @tparam Type
+         * @param peek
+         * @return
+         */
+        template<typename Type> std::vector<Type> podV(bool peek = false)
+        {
+            std::vector<Type> result;
+
+            podV(result, peek);
+
+            return result;
+        }
+
+        /**
+         * Decodes a vector of values from the byte vector into the supplied vector, reusing
+         * its existing elements and capacity
+         *
+         * @tparam Type
+         * @param result
+         * @param peek
+         */
+        template<typename Type, typename Allocator> void podV(std::vector<Type, Allocator> &result, bool peek = false)
+        {
+            const auto start = offset;
+
+            const auto count = varint<uint64_t>();
+
+            // every element occupies at least one byte, so refuse counts that cannot possibly be satisfied
+            require(count);
+
+            result.resize(count);
+
+            for (auto &value : result)
+            {
+                value.deserialize(*this);
+            }
+
+            if (peek)
+            {
+                reset(start);
+            }
+        }
+
+        /**
+         * Decodes a nested vector of values from the byte vector
+         *
+         * @tparam Type
+         * @param peek
+         * @return
+         */
+        template<typename Type> std::vector<std::vector<Type>> podVV(bool peek = false)
+        {
+            std::vector<std::vector<Type>> result;
+
+            podVV(result, peek);
+
+            return result;
+        }
+
+        /**
+         * Decodes a nested vector of values from the byte vector into the supplied vector,
+         * reusing its existing elements and capacity
+         *
+         * @tparam Type
+         * @param result
+         * @param peek
+         */
+        template<typename Type, typename Allocator, typename OuterAllocator>
+        void podVV(std::vector<std::vector<Type, Allocator>, OuterAllocator> &result, bool peek = false)
+        {
+            const auto start = offset;
+
+            const auto level1_count = varint<uint64_t>();
+
+            require(level1_count);
+
+            result.resize(level1_count);
+
+            for (auto &level2 : result)
+            {
+                podV(level2);
+            }
+
+            if (peek)
+            {
+                reset(start);
+            }
+        }
+
+        /**
+         * Decodes a dictionary encoded vector of values from the byte vector
+         *
+         * @tparam Type
+         * @param peek
+         * @return
+         */
+        template<typename Type> std::vector<Type> pod_dictionaryV(bool peek = false)
+        {
+            std::vector<Type> result;
+
+            pod_dictionaryV(result, peek);
+
+            return result;
+        }
+
+        /**
+         * Decodes a dictionary encoded vector of values from the byte vector into the supplied vector,
+         * reusing its existing elements and capacity
+         *
+         * @tparam Type
+         * @param result
+         * @param peek
+         */
+        template<typename Type, typename Allocator>
+        void pod_dictionaryV(std::vector<Type, Allocator> &result, bool peek = false)
+        {
+            std::vector<Type> dictionary;
+
+            std::vector<size_t> indices;
+
+            pod_dictionaryV(dictionary, indices, peek);
+
+            result.resize(indices.size());
+
+            for (size_t i = 0; i < indices.size(); ++i)
+            {
+                result[i] = dictionary[indices[i]];
+            }
+        }
+
+        /**
+         * Decodes a dictionary encoded vector of values from the byte vector without expanding it, such
+         * that each unique value is held in memory once and the values are given by their indices
+         *
+         * @tparam Type
+         * @param dictionary
+         * @param indices
+         * @param peek
+         */
+        template<typename Type, typename Allocator, typename IndexAllocator>
+        void pod_dictionaryV(
+            std::vector<Type, Allocator> &dictionary,
+            std::vector<size_t, IndexAllocator> &indices,
+            bool peek = false)
+        {
+            const auto start = offset;
+
+            podV(dictionary);
+
+            const auto count = varint<uint64_t>();
+
+            // every index occupies at least one byte, so refuse counts that cannot possibly be satisfied
+            require(count);
+
+            indices.resize(count);
+
+            for (auto &index : indices)
+            {
+                const auto position = offset;
+
+                index = varint<size_t>();
+
+                if (index >= dictionary.size())
+                {
+                    reset(start);
+
+                    throw std::range_error(
+                        "dictionary index out of range at position " + std::to_string(base + position));
+                }
+            }
+
+            if (peek)
+            {
+                reset(start);
+            }
+        }
+
+        /**
+         * Decodes a front coded vector of values from the byte vector
+         *
+         * Note: To look values up without decoding the entire vector, use pod_prefix_set_t instead
+         *
+         * @tparam Type
+         * @param peek
+         * @return
+         */
+        template<typename Type> std::vector<Type> pod_prefixV(bool peek = false)
+        {
+            std::vector<Type> result;
+
+            pod_prefixV(result, peek);
+
+            return result;
+        }
+
+        /**
+         * Decodes a front coded vector of values from the byte vector into the supplied vector,
+         * reusing its existing elements and capacity
+         *
+         * @tparam Type
+         * @param result
+         * @param peek
+         */
+        template<typename Type, typename Allocator>
+        void pod_prefixV(std::vector<Type, Allocator> &result, bool peek = false)
+        {
+            const auto start = offset;
+
+            const auto count = varint<uint64_t>();
+
+            const auto interval = varint<uint64_t>();
+
+            if (count != 0 && interval == 0)
+            {
+                reset(start);
+
+                throw std::range_error("invalid restart interval at position " + std::to_string(base + start));
+            }
+
+            auto entries = slice(varint<uint64_t>());
+
+            const auto restarts = count == 0 ? 0 : (count - 1) / interval + 1;
+
+            // every entry occupies at least one byte, so refuse counts that cannot possibly be satisfied
+            entries.require(count);
+
+            require(restarts * sizeof(uint32_t));
+
+            const auto width = Type().size();
+
+            std::vector<unsigned char> current(width);
+
+            result.resize(count);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                const auto position = entries.offset;
+
+                const auto shared = entries.varint<uint64_t>();
+
+                if (shared > width || (i % interval == 0 && shared != 0))
+                {
+                    reset(start);
+
+                    throw std::range_error(
+                        "invalid shared length at position " + std::to_string(entries.base + position));
+                }
+
+                entries.bytes(current.data(), width - shared);
+
+                result[i].deserialize(current);
+            }
+
+            skip(restarts * sizeof(uint32_t));
+
+            if (peek)
+            {
+                reset(start);
+            }
+        }
+
+        /**
+         * Decodes a sparse pod (see serializer_t::pod_sparse) from the byte vector
          *
          * @tparam Type
          * @param peek
          * @return
          */
-        template<typename Type> Type pod(bool peek = false)
+        template<typename Type> Type pod_sparse(bool peek = false)
         {
             Type result;
 
-            const auto data = bytes(result.size(), peek);
+            std::vector<unsigned char> raw(result.size());
 
-            result.deserialize(data);
+            sparse(raw.data(), raw.size(), peek);
+
+            result.deserialize(raw);
 
             return result;
         }
 
         /**
-         * Decodes a vector of values from the byte vector
+         * Decodes a vector of sparse pods from the byte vector
          *
          * @tparam Type
          * @param peek
          * @return
          */
-        template<typename Type> std::vector<Type> podV(bool peek = false)
+        template<typename Type> std::vector<Type> pod_sparseV(bool peek = false)
         {
-            const auto start = offset;
-
-            const auto count = varint<uint64_t>();
-
             std::vector<Type> result;
 
-            const Type temp;
-
-            for (uint64_t i = 0; i < count; ++i)
-            {
-                result.push_back(pod<Type>());
-            }
-
-            if (peek)
-            {
-                reset(start);
-            }
+            pod_sparseV(result, peek);
 
             return result;
         }
 
         /**
-         * Decodes a nested vector of values from the byte vector
+         * Decodes a vector of sparse pods from the byte vector into the supplied vector, reusing its
+         * existing elements and capacity
          *
          * @tparam Type
+         * @param result
          * @param peek
-         * @return
          */
-        template<typename Type> std::vector<std::vector<Type>> podVV(bool peek = false)
+        template<typename Type, typename Allocator>
+        void pod_sparseV(std::vector<Type, Allocator> &result, bool peek = false)
         {
             const auto start = offset;
 
-            const auto level1_count = varint<uint64_t>();
-
-            std::vector<std::vector<Type>> result;
+            std::vector<unsigned char> raw;
 
-            for (uint64_t i = 0; i < level1_count; ++i)
+            try
             {
                 const auto count = varint<uint64_t>();
 
-                std::vector<Type> level2;
+                // every value occupies at least its marker byte, so refuse counts that cannot be satisfied
+                require(count);
 
-                for (uint64_t j = 0; j < count; ++j)
+                result.resize(count);
+
+                for (auto &value : result)
                 {
-                    level2.push_back(pod<Type>());
+                    raw.resize(value.size());
+
+                    sparse(raw.data(), raw.size(), false);
+
+                    value.deserialize(raw);
                 }
+            }
+            catch (...)
+            {
+                reset(start);
 
-                result.push_back(level2);
+                throw;
             }
 
             if (peek)
             {
                 reset(start);
             }
-
-            return result;
         }
 
         /**
@@ -174,12 +673,168 @@ namespace Serialization
          */
         [[nodiscard]] size_t size() const;
 
+        /**
+         * Returns a reader over the next specified bytes that shares the underlying byte vector
+         * with this reader (no copy is made) but has its own bounds and position
+         *
+         * Note: Positions within the returned reader are relative to the start of the slice,
+         * while errors raised by it report absolute positions within the underlying byte vector
+         *
+         * @param count
+         * @param peek if set, this reader is not advanced past the slice
+         * @return
+         */
+        deserializer_t slice(size_t count, bool peek = false);
+
         /**
          * Skips the next specified bytes while reading
          * @param count
          */
         void skip(size_t count = 1);
 
+        /**
+         * Decodes a Stream VByte encoded vector of values from the byte vector
+         * @tparam Type
+         * @param peek
+         * @return
+         */
+        template<typename Type> std::vector<Type> streamvbyteV(bool peek = false)
+        {
+            std::vector<Type> result;
+
+            streamvbyteV(result, peek);
+
+            return result;
+        }
+
+        /**
+         * Decodes a Stream VByte encoded vector of values from the byte vector into the supplied vector,
+         * reusing its capacity
+         * @tparam Type
+         * @param result
+         * @param peek
+         */
+        template<typename Type, typename Allocator>
+        void streamvbyteV(std::vector<Type, Allocator> &result, bool peek = false)
+        {
+            static_assert(
+                std::is_unsigned_v<Type> && sizeof(Type) <= sizeof(uint32_t),
+                "stream vbyte requires an unsigned integer type of at most 32 bits");
+
+            const auto start = offset;
+
+            const auto count = varint<uint64_t>();
+
+            // every element occupies at least one data byte, which also covers the control bytes read below
+            require(count);
+
+            const auto control = data() + offset;
+
+            const auto control_length = StreamVByte::control_size(count);
+
+            const auto data_length = StreamVByte::data_size(control, count);
+
+            require(control_length + data_length);
+
+            result.resize(count);
+
+            if constexpr (std::is_same_v<Type, uint32_t>)
+            {
+                StreamVByte::decode(control, control + control_length, data_length, count, result.data());
+            }
+            else
+            {
+                // narrow a block at a time through a stack buffer so that no allocation is made beyond the
+                // supplied vector; the block size is a multiple of four so each block starts on a control byte
+                uint32_t values[256];
+
+                const auto stream = control + control_length;
+
+                for (size_t i = 0, position = 0; i < count; i += 256)
+                {
+                    const auto block = std::min<size_t>(256, count - i);
+
+                    position += StreamVByte::decode(
+                        control + i / 4, stream + position, data_length - position, block, values);
+
+                    for (size_t j = 0; j < block; ++j)
+                    {
+                        if (values[j] > std::numeric_limits<Type>::max())
+                        {
+                            reset(start);
+
+                            throw std::range_error(
+                                "value is out of range for type at position " + std::to_string(base + start));
+                        }
+
+                        result[i + j] = Type(values[j]);
+                    }
+                }
+            }
+
+            offset += control_length + data_length;
+
+            if (peek)
+            {
+                reset(start);
+            }
+        }
+
+        /**
+         * Decodes a signed zigzag mapped varint value from the byte vector
+         * @tparam Type
+         * @param peek
+         * @return
+         */
+        template<typename Type> Type svarint(bool peek = false)
+        {
+            return zigzag_decode<Type>(varint<std::make_unsigned_t<Type>>(peek));
+        }
+
+        /**
+         * Decodes a vector of signed zigzag mapped varint values from the byte vector
+         * @tparam Type
+         * @param peek
+         * @return
+         */
+        template<typename Type> std::vector<Type> svarintV(bool peek = false)
+        {
+            std::vector<Type> result;
+
+            svarintV(result, peek);
+
+            return result;
+        }
+
+        /**
+         * Decodes a vector of signed zigzag mapped varint values from the byte vector into the supplied
+         * vector, reusing its capacity
+         * @tparam Type
+         * @param result
+         * @param peek
+         */
+        template<typename Type, typename Allocator> void svarintV(std::vector<Type, Allocator> &result, bool peek = false)
+        {
+            const auto start = offset;
+
+            const auto count = varint<uint64_t>();
+
+            // every element occupies at least one byte, so refuse counts that cannot possibly be satisfied
+            require(count);
+
+            result.resize(count);
+
+            for (auto &value : result)
+            {
+                value = svarint<Type>();
+            }
+
+            if (peek)
+            {
+                reset(start);
+            }
+        }
+
         /**
          * Returns the hex encoding of the underlying byte vector
          * @return
@@ -201,6 +856,37 @@ namespace Serialization
          */
         uint16_t uint16(bool peek = false, bool big_endian = false);
 
+        /**
+         * Decodes the given number of fixed width values, written without a length prefix, from the byte
+         * vector into the output
+         * @param output
+         * @param count
+         * @param peek
+         * @param big_endian
+         */
+        void uint16(uint16_t *output, size_t count, bool peek = false, bool big_endian = false);
+
+        /**
+         * Decodes a vector of fixed width values from the byte vector
+         * @param peek
+         * @param big_endian
+         * @return
+         */
+        std::vector<uint16_t> uint16V(bool peek = false, bool big_endian = false);
+
+        /**
+         * Decodes a vector of fixed width values from the byte vector into the supplied vector, reusing
+         * its capacity
+         * @param result
+         * @param peek
+         * @param big_endian
+         */
+        template<typename Allocator>
+        void uint16V(std::vector<uint16_t, Allocator> &result, bool peek = false, bool big_endian = false)
+        {
+            fixedV(result, peek, big_endian);
+        }
+
         /**
          * Decodes a value from the byte vector
          * @param peek
@@ -209,6 +895,37 @@ namespace Serialization
          */
         uint32_t uint32(bool peek = false, bool big_endian = false);
 
+        /**
+         * Decodes the given number of fixed width values, written without a length prefix, from the byte
+         * vector into the output
+         * @param output
+         * @param count
+         * @param peek
+         * @param big_endian
+         */
+        void uint32(uint32_t *output, size_t count, bool peek = false, bool big_endian = false);
+
+        /**
+         * Decodes a vector of fixed width values from the byte vector
+         * @param peek
+         * @param big_endian
+         * @return
+         */
+        std::vector<uint32_t> uint32V(bool peek = false, bool big_endian = false);
+
+        /**
+         * Decodes a vector of fixed width values from the byte vector into the supplied vector, reusing
+         * its capacity
+         * @param result
+         * @param peek
+         * @param big_endian
+         */
+        template<typename Allocator>
+        void uint32V(std::vector<uint32_t, Allocator> &result, bool peek = false, bool big_endian = false)
+        {
+            fixedV(result, peek, big_endian);
+        }
+
         /**
          * Decodes a value from the byte vector
          * @param peek
@@ -217,6 +934,37 @@ namespace Serialization
          */
         uint64_t uint64(bool peek = false, bool big_endian = false);
 
+        /**
+         * Decodes the given number of fixed width values, written without a length prefix, from the byte
+         * vector into the output
+         * @param output
+         * @param count
+         * @param peek
+         * @param big_endian
+         */
+        void uint64(uint64_t *output, size_t count, bool peek = false, bool big_endian = false);
+
+        /**
+         * Decodes a vector of fixed width values from the byte vector
+         * @param peek
+         * @param big_endian
+         * @return
+         */
+        std::vector<uint64_t> uint64V(bool peek = false, bool big_endian = false);
+
+        /**
+         * Decodes a vector of fixed width values from the byte vector into the supplied vector, reusing
+         * its capacity
+         * @param result
+         * @param peek
+         * @param big_endian
+         */
+        template<typename Allocator>
+        void uint64V(std::vector<uint64_t, Allocator> &result, bool peek = false, bool big_endian = false)
+        {
+            fixedV(result, peek, big_endian);
+        }
+
         /**
          * Decodes a value from the byte vector
          * @param peek
@@ -241,16 +989,21 @@ namespace Serialization
          */
         template<typename Type> Type varint(bool peek = false)
         {
-            const auto start = offset;
+            try
+            {
+                const auto [result, length] = decode_varint<Type>(data(), size(), offset);
 
-            const auto [result, length] = decode_varint<Type>(buffer, start);
+                if (!peek)
+                {
+                    offset += length;
+                }
 
-            if (!peek)
+                return result;
+            }
+            catch (const std::range_error &e)
             {
-                offset += length;
+                throw std::range_error(std::string(e.what()) + " at position " + std::to_string(base + offset));
             }
-
-            return result;
         }
 
         /**
@@ -260,26 +1013,40 @@ namespace Serialization
          * @return
          */
         template<typename Type> std::vector<Type> varintV(bool peek = false)
+        {
+            std::vector<Type> result;
+
+            varintV(result, peek);
+
+            return result;
+        }
+
+        /**
+         * Decodes a vector of values from the byte vector into the supplied vector, reusing its capacity
+         * @tparam Type
+         * @param result
+         * @param peek
+         */
+        template<typename Type, typename Allocator> void varintV(std::vector<Type, Allocator> &result, bool peek = false)
         {
             const auto start = offset;
 
             const auto count = varint<uint64_t>();
 
-            std::vector<Type> result;
+            // every element occupies at least one byte, so refuse counts that cannot possibly be satisfied
+            require(count);
 
-            for (uint64_t i = 0; i < count; ++i)
-            {
-                const auto temp = varint<Type>();
+            result.resize(count);
 
-                result.push_back(temp);
+            for (auto &value : result)
+            {
+                value = varint<Type>();
             }
 
             if (peek)
             {
                 reset(start);
             }
-
-            return result;
         }
 
         /**
@@ -295,9 +1062,92 @@ namespace Serialization
         [[nodiscard]] std::vector<unsigned char> unread_data() const;
 
       private:
-        std::vector<unsigned char> buffer;
+        /**
+         * Creates a storage vector, allocated entirely from the given resource, from the supplied range
+         * @tparam Args
+         * @param resource
+         * @param args
+         * @return
+         */
+        template<typename... Args>
+        static std::shared_ptr<std::pmr::vector<unsigned char>> create(std::pmr::memory_resource *resource, Args &&...args)
+        {
+            const auto allocator = std::pmr::polymorphic_allocator<std::pmr::vector<unsigned char>>(resource);
+
+            return std::allocate_shared<std::pmr::vector<unsigned char>>(allocator, std::forward<Args>(args)...);
+        }
+
+        /**
+         * Makes the supplied storage vector the underlying byte vector of the reader
+         * @param value
+         */
+        void adopt(std::shared_ptr<std::pmr::vector<unsigned char>> value);
+
+        /**
+         * Decodes the given number of values of the given width from the byte vector into the output
+         * @param output
+         * @param count
+         * @param width
+         * @param peek
+         * @param big_endian
+         */
+        void fixed(void *output, size_t count, size_t width, bool peek, bool big_endian);
+
+        /**
+         * Decodes a length-prefixed vector of fixed width values from the byte vector into the
+         * supplied vector
+         * @tparam Type
+         * @param result
+         * @param peek
+         * @param big_endian
+         */
+        template<typename Type, typename Allocator>
+        void fixedV(std::vector<Type, Allocator> &result, bool peek, bool big_endian)
+        {
+            const auto start = offset;
+
+            const auto count = varint<uint64_t>();
+
+            // refuse counts that cannot possibly be satisfied before allocating for them
+            require(count);
+
+            require(count * sizeof(Type));
+
+            result.resize(count);
+
+            fixed(result.data(), count, sizeof(Type), false, big_endian);
+
+            if (peek)
+            {
+                reset(start);
+            }
+        }
+
+        /**
+         * Throws if fewer than the specified bytes remain unread
+         * @param count
+         */
+        void require(size_t count) const;
+
+        /**
+         * Decodes a sparse pod of the given width from the byte vector into the output
+         * @param output
+         * @param width
+         * @param peek
+         */
+        void sparse(unsigned char *output, size_t width, bool peek);
+
+        // keeps the underlying bytes alive for as long as any reader refers to them
+        std::shared_ptr<const void> buffer;
+
+        // the underlying byte vector if it was created by a reader (and thus may be reused)
+        std::pmr::vector<unsigned char> *storage = nullptr;
+
+        std::pmr::memory_resource *resource = std::pmr::get_default_resource();
+
+        const unsigned char *memory = nullptr;
 
-        size_t offset = 0;
+        size_t base = 0, length = 0, offset = 0;
     };
 
 } // namespace Serialization
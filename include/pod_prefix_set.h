@@ -0,0 +1,286 @@
+// Copyright (c) 2020-2024, Brandon Lehmann
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef SERIALIZATION_POD_PREFIX_SET_H
+#define SERIALIZATION_POD_PREFIX_SET_H
+
+#include <deserializer_t.h>
+
+namespace Serialization
+{
+    /**
+     * Provides lookups into a front coded vector of values (as written by serializer_t::pod_prefix)
+     * without decoding the entire vector: a lookup binary searches the restart points, which are stored
+     * in full, and then decodes at most one restart interval of entries
+     *
+     * Note: The set refers to the bytes of the reader it was created from (which are reference counted)
+     * rather than copying them.
+     *
+     * @tparam Type
+     */
+    template<typename Type> struct pod_prefix_set_t final
+    {
+        /**
+         * Reads a front coded vector of values from the reader, advancing the reader past it
+         *
+         * @param reader
+         */
+        explicit pod_prefix_set_t(deserializer_t &reader)
+        {
+            const auto start = reader.size() - reader.unread_bytes();
+
+            count = reader.varint<uint64_t>();
+
+            interval = reader.varint<uint64_t>();
+
+            if (count != 0 && interval == 0)
+            {
+                reader.reset(start);
+
+                throw std::range_error("invalid restart interval at position " + std::to_string(start));
+            }
+
+            try
+            {
+                entries = reader.slice(reader.varint<uint64_t>());
+
+                restarts.resize(count == 0 ? 0 : (count - 1) / interval + 1);
+
+                reader.uint32(restarts.data(), restarts.size());
+            }
+            catch (...)
+            {
+                reader.reset(start);
+
+                throw;
+            }
+
+            for (const auto &restart : restarts)
+            {
+                if (restart >= entries.size())
+                {
+                    reader.reset(start);
+
+                    throw std::range_error("restart point out of range at position " + std::to_string(start));
+                }
+            }
+        }
+
+        /**
+         * Decodes the value at the given index
+         *
+         * @param index
+         * @return
+         */
+        [[nodiscard]] Type at(size_t index) const
+        {
+            if (index >= count)
+            {
+                throw std::out_of_range("index out of range");
+            }
+
+            auto reader = seek(index / interval);
+
+            std::vector<unsigned char> current(width);
+
+            for (size_t i = index - index % interval; i < index; ++i)
+            {
+                decode(reader, current, i);
+            }
+
+            return decode(reader, current, index);
+        }
+
+        /**
+         * Returns whether the value is in the set
+         *
+         * @param value
+         * @return
+         */
+        [[nodiscard]] bool contains(const Type &value) const
+        {
+            size_t index;
+
+            return find(value, index);
+        }
+
+        /**
+         * Returns the index of the first value in the set that is not less than the given value, or the
+         * size of the set if there is no such value
+         *
+         * @param value
+         * @return
+         */
+        [[nodiscard]] size_t lower_bound(const Type &value) const
+        {
+            size_t index;
+
+            find(value, index);
+
+            return index;
+        }
+
+        /**
+         * Returns the number of values in the set
+         *
+         * @return
+         */
+        [[nodiscard]] size_t size() const
+        {
+            return count;
+        }
+
+        /**
+         * Decodes every value in the set
+         *
+         * @return
+         */
+        [[nodiscard]] std::vector<Type> values() const
+        {
+            std::vector<Type> result(count);
+
+            auto reader = seek(0);
+
+            std::vector<unsigned char> current(width);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                result[i] = decode(reader, current, i);
+            }
+
+            return result;
+        }
+
+      private:
+        /**
+         * Decodes the entry at the given index from the reader, which must be positioned at it, on top of
+         * the bytes of the entry before it
+         *
+         * @param reader
+         * @param current
+         * @param index
+         * @return
+         */
+        Type decode(deserializer_t &reader, std::vector<unsigned char> &current, size_t index) const
+        {
+            const auto position = reader.size() - reader.unread_bytes();
+
+            const auto shared = reader.varint<uint64_t>();
+
+            if (shared > width || (index % interval == 0 && shared != 0))
+            {
+                throw std::range_error("invalid shared length at position " + std::to_string(position));
+            }
+
+            reader.bytes(current.data(), width - shared);
+
+            Type result;
+
+            result.deserialize(current);
+
+            return result;
+        }
+
+        /**
+         * Locates the first value in the set that is not less than the given value, returning whether it
+         * is equal to the given value
+         *
+         * @param value
+         * @param index
+         * @return
+         */
+        bool find(const Type &value, size_t &index) const
+        {
+            // binary search for the first restart point whose value is greater than the given value
+            size_t low = 0, high = restarts.size();
+
+            std::vector<unsigned char> current(width);
+
+            while (low < high)
+            {
+                const auto middle = low + (high - low) / 2;
+
+                auto reader = seek(middle);
+
+                if (value < decode(reader, current, middle * interval))
+                {
+                    high = middle;
+                }
+                else
+                {
+                    low = middle + 1;
+                }
+            }
+
+            if (low == 0)
+            {
+                index = 0;
+
+                return false;
+            }
+
+            // the value can only be within the interval of the restart point before it
+            auto reader = seek(low - 1);
+
+            const auto end = std::min<size_t>(count, low * interval);
+
+            for (index = (low - 1) * interval; index < end; ++index)
+            {
+                const auto candidate = decode(reader, current, index);
+
+                if (!(candidate < value))
+                {
+                    return !(value < candidate);
+                }
+            }
+
+            return false;
+        }
+
+        /**
+         * Returns a reader positioned at the given restart point
+         *
+         * @param restart
+         * @return
+         */
+        [[nodiscard]] deserializer_t seek(size_t restart) const
+        {
+            auto reader = entries;
+
+            reader.reset(restarts[restart]);
+
+            return reader;
+        }
+
+        size_t count = 0, interval = 0, width = Type().size();
+
+        deserializer_t entries {};
+
+        std::vector<uint32_t> restarts;
+    };
+} // namespace Serialization
+
+#endif
@@ -0,0 +1,229 @@
+// Copyright (c) 2020-2024, Brandon Lehmann
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef SERIALIZATION_RECORD_STREAM_H
+#define SERIALIZATION_RECORD_STREAM_H
+
+#include <deserializer_t.h>
+#include <iostream>
+#include <serializer_t.h>
+
+namespace Serialization
+{
+    /**
+     * The position of a record within a record stream
+     */
+    struct record_stream_entry_t
+    {
+        uint64_t record;
+
+        uint64_t offset;
+    };
+
+    /**
+     * Writes serialized records to a flat, append-only record stream (such as a file)
+     *
+     * The stream is a series of frames, each a varint of its body length and kind followed by the body:
+     * records; index blocks, which hold the offset of every stride-th record and the offset of the index
+     * block before them; and footers, which hold the record count and the offset of the last index block.
+     * Index blocks are written every block_size index entries and a footer is written when the writer is
+     * closed, such that the stream ends in a fixed size footer from which the whole index can be found.
+     *
+     * Note: Reopening a stream to append to it reads the footer at its end and continues after it; the
+     * existing data, including the old footer (which readers skip), is never rewritten.
+     */
+    struct record_stream_writer_t final
+    {
+        /**
+         * Constructs a writer that appends to the stream, which must be seekable and opened for reading
+         * and writing (ie. std::ios::in | std::ios::out | std::ios::binary); an empty stream starts a new
+         * record stream, otherwise the stream must end in a footer
+         *
+         * @param stream
+         * @param stride the number of records between each index entry
+         * @param block_size the number of index entries held in each index block
+         */
+        explicit record_stream_writer_t(std::iostream &stream, size_t stride = 64, size_t block_size = 1024);
+
+        ~record_stream_writer_t();
+
+        record_stream_writer_t(const record_stream_writer_t &) = delete;
+
+        record_stream_writer_t &operator=(const record_stream_writer_t &) = delete;
+
+        /**
+         * Appends the output of the writer to the stream as a record
+         *
+         * @param record
+         */
+        void append(const serializer_t &record);
+
+        /**
+         * Appends the data to the stream as a record
+         *
+         * @param data
+         * @param length
+         */
+        void append(const void *data, size_t length);
+
+        /**
+         * Writes any pending index entries and the footer, after which the stream is a complete record
+         * stream; records appended afterward start a new index and require another close()
+         *
+         * Note: This also happens when the writer is destroyed, but errors are then discarded
+         */
+        void close();
+
+        /**
+         * Returns the number of records in the stream
+         *
+         * @return
+         */
+        [[nodiscard]] uint64_t size() const;
+
+      private:
+        /**
+         * Writes the header of a frame of the given kind and body length to the stream
+         *
+         * @param kind
+         * @param length
+         */
+        void header(uint8_t kind, uint64_t length);
+
+        /**
+         * Writes the pending index entries to the stream as an index block
+         */
+        void index();
+
+        /**
+         * Writes the segments to the stream as a record
+         *
+         * @param segments
+         */
+        void record(const std::vector<buffer_segment_t> &segments);
+
+        /**
+         * Writes the data to the stream, throwing if the stream has failed
+         *
+         * @param data
+         * @param length
+         */
+        void write(const void *data, size_t length);
+
+        std::iostream &stream;
+
+        size_t stride, block_size;
+
+        uint64_t count = 0, last_index;
+
+        std::vector<record_stream_entry_t> pending;
+
+        bool dirty = false;
+    };
+
+    /**
+     * Reads serialized records from a record stream (see record_stream_writer_t), either in order or
+     * starting from any record by binary searching the index
+     *
+     * Note: To read a record stream in parallel, give each reader its own stream and have each seek() to
+     * a different boundary (see boundaries()), reading until it reaches the next boundary.
+     */
+    struct record_stream_reader_t final
+    {
+        /**
+         * Constructs a reader over the stream, which must be seekable, reading the footer and the index
+         * and positioning the reader at the first record
+         *
+         * @param stream
+         */
+        explicit record_stream_reader_t(std::istream &stream);
+
+        /**
+         * Returns the indexed positions at which the stream may be split into independently readable
+         * ranges of records, in ascending order
+         *
+         * @return
+         */
+        [[nodiscard]] const std::vector<record_stream_entry_t> &boundaries() const;
+
+        /**
+         * Reads the next record into the supplied reader, reusing its capacity
+         *
+         * @param record
+         * @return false if there are no more records
+         */
+        bool next(deserializer_t &record);
+
+        /**
+         * Reads the next record into the supplied vector, reusing its capacity
+         *
+         * @param record
+         * @return false if there are no more records
+         */
+        bool next(std::vector<unsigned char> &record);
+
+        /**
+         * Returns the number of the next record that will be read
+         *
+         * @return
+         */
+        [[nodiscard]] uint64_t position() const;
+
+        /**
+         * Positions the reader at the given record
+         *
+         * @param record
+         */
+        void seek(uint64_t record);
+
+        /**
+         * Returns the number of records in the stream
+         *
+         * @return
+         */
+        [[nodiscard]] uint64_t size() const;
+
+      private:
+        /**
+         * Reads the header of the next frame, returning false at the end of the stream
+         *
+         * @param kind
+         * @param length
+         * @return
+         */
+        bool header(uint8_t &kind, uint64_t &length);
+
+        std::istream &stream;
+
+        uint64_t count = 0, current = 0, end = 0;
+
+        std::vector<record_stream_entry_t> entries;
+
+        std::vector<unsigned char> buffer;
+    };
+} // namespace Serialization
+
+#endif
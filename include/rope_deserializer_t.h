@@ -0,0 +1,389 @@
+// Copyright (c) 2020-2024, Brandon Lehmann
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef SERIALIZATION_ROPE_DESERIALIZER_T
+#define SERIALIZATION_ROPE_DESERIALIZER_T
+
+#include <serializer_t.h>
+
+namespace Serialization
+{
+    /**
+     * Reads values from a chain of non-contiguous byte segments (such as a list of receive buffers)
+     * without first coalescing them into a single byte vector. Values that lie entirely within a
+     * single segment are read in place; only values that straddle a segment boundary are copied.
+     */
+    struct rope_deserializer_t final
+    {
+        /**
+         * Constructs the reader over the supplied chunks, taking ownership of them
+         *
+         * @param chunks
+         */
+        explicit rope_deserializer_t(std::vector<std::vector<unsigned char>> &&chunks);
+
+        /**
+         * Constructs the reader over the supplied segments
+         *
+         * Note: The reader does not take ownership of the memory referenced by the segments,
+         * which must remain valid and unmodified for the lifetime of the reader
+         *
+         * @param segments
+         */
+        explicit rope_deserializer_t(const std::vector<buffer_segment_t> &segments);
+
+        /**
+         * Constructs a copy of the reader, including its position, whose segments reference its own
+         * copies of the owned chunks (segments that the reader does not own are shared)
+         *
+         * @param other
+         */
+        rope_deserializer_t(const rope_deserializer_t &other);
+
+        rope_deserializer_t(rope_deserializer_t &&) = default;
+
+        rope_deserializer_t &operator=(const rope_deserializer_t &other);
+
+        rope_deserializer_t &operator=(rope_deserializer_t &&) = default;
+
+        /**
+         * Appends the supplied chunk to the end of the reader, taking ownership of it
+         *
+         * @param chunk
+         */
+        void append(std::vector<unsigned char> &&chunk);
+
+        /**
+         * Decodes a value from the segments
+         * @param peek
+         * @return
+         */
+        bool boolean(bool peek = false);
+
+        /**
+         * Returns a byte vector of the given length from the segments
+         * @param count
+         * @param peek
+         * @return
+         */
+        std::vector<unsigned char> bytes(size_t count = 1, bool peek = false);
+
+        /**
+         * Copies the given number of bytes from the segments into the supplied output
+         * @param output
+         * @param count
+         * @param peek
+         */
+        void bytes(void *output, size_t count, bool peek = false);
+
+        /**
+         * Decodes a hex encoded string of the given length from the segments
+         * @param length
+         * @param peek
+         * @return
+         */
+        std::string hex(size_t length = 1, bool peek = false);
+
+        /**
+         * Decodes a value from the segments
+         *
+         * @tparam Type
+         * @param peek
+         * @return
+         */
+        template<typename Type> Type pod(bool peek = false)
+        {
+            Type result;
+
+            const auto data = bytes(result.size(), peek);
+
+            result.deserialize(data);
+
+            return result;
+        }
+
+        /**
+         * Decodes a vector of values from the segments
+         *
+         * @tparam Type
+         * @param peek
+         * @return
+         */
+        template<typename Type> std::vector<Type> podV(bool peek = false)
+        {
+            std::vector<Type> result;
+
+            podV(result, peek);
+
+            return result;
+        }
+
+        /**
+         * Decodes a vector of values from the segments into the supplied vector, reusing
+         * its existing elements and capacity
+         *
+         * @tparam Type
+         * @param result
+         * @param peek
+         */
+        template<typename Type, typename Allocator> void podV(std::vector<Type, Allocator> &result, bool peek = false)
+        {
+            const auto start = offset;
+
+            const auto count = varint<uint64_t>();
+
+            require(count);
+
+            result.resize(count);
+
+            for (auto &value : result)
+            {
+                value.deserialize(bytes(value.size()));
+            }
+
+            if (peek)
+            {
+                reset(start);
+            }
+        }
+
+        /**
+         * Resets the reader to the given position (default 0)
+         * @param position
+         */
+        void reset(size_t position = 0);
+
+        /**
+         * Returns the total size of all segments in bytes
+         * @return
+         */
+        [[nodiscard]] size_t size() const;
+
+        /**
+         * Skips the next specified bytes while reading
+         * @param count
+         */
+        void skip(size_t count = 1);
+
+        /**
+         * Decodes a value from the segments
+         * @param peek
+         * @return
+         */
+        unsigned char uint8(bool peek = false);
+
+        /**
+         * Decodes a value from the segments
+         * @param peek
+         * @param big_endian
+         * @return
+         */
+        uint16_t uint16(bool peek = false, bool big_endian = false);
+
+        /**
+         * Decodes a value from the segments
+         * @param peek
+         * @param big_endian
+         * @return
+         */
+        uint32_t uint32(bool peek = false, bool big_endian = false);
+
+        /**
+         * Decodes a value from the segments
+         * @param peek
+         * @param big_endian
+         * @return
+         */
+        uint64_t uint64(bool peek = false, bool big_endian = false);
+
+        /**
+         * Decodes a value from the segments
+         * @param peek
+         * @param big_endian
+         * @return
+         */
+        uint128_t uint128(bool peek = false, bool big_endian = false);
+
+        /**
+         * Decodes a value from the segments
+         * @param peek
+         * @param big_endian
+         * @return
+         */
+        uint256_t uint256(bool peek = false, bool big_endian = false);
+
+        /**
+         * Returns the remaining number of bytes that have not been read from the segments
+         * @return
+         */
+        [[nodiscard]] size_t unread_bytes() const;
+
+        /**
+         * Decodes a value from the segments
+         * @tparam Type
+         * @param peek
+         * @return
+         */
+        template<typename Type> Type varint(bool peek = false)
+        {
+            // the longest varint that encode_varint() will produce for the type
+            constexpr auto max_length = varint_max_length<Type>();
+
+            // fast path: the varint terminates within the current segment
+            if (segment < segments.size())
+            {
+                const auto &current = segments[segment];
+
+                const auto available = std::min(current.length - position, max_length);
+
+                for (size_t i = 0; i < available; ++i)
+                {
+                    if (current.data[position + i] < 0x80)
+                    {
+                        const auto [result, length] = decode_varint<Type>(current.data + position, i + 1);
+
+                        if (!peek)
+                        {
+                            skip(length);
+                        }
+
+                        return result;
+                    }
+                }
+            }
+
+            unsigned char temp[max_length];
+
+            const auto length = std::min(unread_bytes(), max_length);
+
+            bytes(temp, length, true);
+
+            const auto [result, used] = decode_varint<Type>(temp, length);
+
+            if (!peek)
+            {
+                skip(used);
+            }
+
+            return result;
+        }
+
+        /**
+         * Decodes a vector of values from the segments
+         * @tparam Type
+         * @param peek
+         * @return
+         */
+        template<typename Type> std::vector<Type> varintV(bool peek = false)
+        {
+            std::vector<Type> result;
+
+            varintV(result, peek);
+
+            return result;
+        }
+
+        /**
+         * Decodes a vector of values from the segments into the supplied vector, reusing its capacity
+         * @tparam Type
+         * @param result
+         * @param peek
+         */
+        template<typename Type, typename Allocator> void varintV(std::vector<Type, Allocator> &result, bool peek = false)
+        {
+            const auto start = offset;
+
+            const auto count = varint<uint64_t>();
+
+            require(count);
+
+            result.resize(count);
+
+            for (auto &value : result)
+            {
+                value = varint<Type>();
+            }
+
+            if (peek)
+            {
+                reset(start);
+            }
+        }
+
+      private:
+        /**
+         * Decodes a fixed width value from the segments
+         * @tparam Type
+         * @param peek
+         * @param big_endian
+         * @return
+         */
+        template<typename Type> Type fixed(bool peek, bool big_endian)
+        {
+            require(sizeof(Type));
+
+            const auto &current = segments[segment];
+
+            Type result;
+
+            if (current.length - position >= sizeof(Type))
+            {
+                result = unpack<Type>(current.data, current.length, position, big_endian);
+            }
+            else
+            {
+                unsigned char temp[sizeof(Type)];
+
+                bytes(temp, sizeof(Type), true);
+
+                result = unpack<Type>(temp, sizeof(Type), 0, big_endian);
+            }
+
+            if (!peek)
+            {
+                skip(sizeof(Type));
+            }
+
+            return result;
+        }
+
+        /**
+         * Throws if fewer than the specified bytes remain unread
+         * @param count
+         */
+        void require(size_t count) const;
+
+        std::vector<std::vector<unsigned char>> chunks;
+
+        std::vector<buffer_segment_t> segments;
+
+        std::vector<size_t> starts;
+
+        size_t length = 0, offset = 0, segment = 0, position = 0;
+    };
+} // namespace Serialization
+
+#endif
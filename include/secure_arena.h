@@ -0,0 +1,118 @@
+// Copyright (c) 2020-2024, Brandon Lehmann
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef SERIALIZATION_SECURE_ARENA_H
+#define SERIALIZATION_SECURE_ARENA_H
+
+#include <memory_resource>
+#include <vector>
+
+namespace Serialization
+{
+    /**
+     * A monotonic memory resource intended for secret-holding objects (ie. SerializablePod secrets)
+     * that tracks every block it hands out. Memory returned to the arena (ie. the old storage left
+     * behind when a std::pmr::vector grows) is wiped immediately and all blocks are wiped in bulk,
+     * a block at a time, when the arena is released or destroyed.
+     *
+     * Note: While a scope_t for the arena is active on a thread, SerializablePod instances that
+     * live in the arena and are destroyed on that thread skip their individual wipe as the arena
+     * guarantees it will wipe their memory when it is deallocated or released.
+     */
+    struct secure_arena_t final : std::pmr::memory_resource
+    {
+        /**
+         * Marks the arena as the active secure arena of the calling thread for the lifetime of the scope
+         */
+        struct scope_t final
+        {
+            explicit scope_t(const secure_arena_t &arena);
+
+            ~scope_t();
+
+            scope_t(const scope_t &) = delete;
+
+            scope_t &operator=(const scope_t &) = delete;
+
+          private:
+            const secure_arena_t *previous;
+        };
+
+        explicit secure_arena_t(
+            size_t initial_size = 4096,
+            std::pmr::memory_resource *upstream = std::pmr::get_default_resource());
+
+        ~secure_arena_t() override;
+
+        secure_arena_t(const secure_arena_t &) = delete;
+
+        secure_arena_t &operator=(const secure_arena_t &) = delete;
+
+        /**
+         * Returns whether the pointer lies within the active secure arena of the calling thread
+         *
+         * @param pointer
+         * @return
+         */
+        [[nodiscard]] static bool covers(const void *pointer);
+
+        /**
+         * Returns whether the pointer lies within memory handed out by the arena
+         *
+         * @param pointer
+         * @return
+         */
+        [[nodiscard]] bool contains(const void *pointer) const;
+
+        /**
+         * Wipes every block held by the arena and returns them to the upstream resource
+         */
+        void release();
+
+        /**
+         * Returns the total size of the blocks held by the arena
+         *
+         * @return
+         */
+        [[nodiscard]] size_t size() const;
+
+      protected:
+        void *do_allocate(size_t bytes, size_t alignment) override;
+
+        void do_deallocate(void *pointer, size_t bytes, size_t alignment) override;
+
+        [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+      private:
+        std::pmr::memory_resource *upstream;
+
+        std::vector<std::pair<unsigned char *, size_t>> blocks;
+
+        size_t next_size, used = 0;
+    };
+} // namespace Serialization
+
+#endif
@@ -32,6 +32,9 @@
 /**
  * Wipes the pointer memory such that the entire pointer is filled with 0s
  *
+ * Note: Uses the platform's non-elidable wipe (SecureZeroMemory, explicit_bzero, memset_s) where
+ * available; large buffers are wiped using non-temporal stores to avoid polluting the cache
+ *
  * @param pointer
  * @param length
  */
@@ -0,0 +1,108 @@
+// Copyright (c) 2020-2024, Brandon Lehmann
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef SERIALIZATION_SECURE_RESOURCE_H
+#define SERIALIZATION_SECURE_RESOURCE_H
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace Serialization
+{
+    /**
+     * A memory resource that wipes memory before returning it to its upstream resource, such that
+     * buffers holding secrets (ie. the byte vector of a serializer_t or deserializer_t) do not leave
+     * copies behind when they grow or are destroyed. Optionally, the memory is also locked into RAM
+     * (mlock/VirtualLock) to keep it out of swap; locking is best effort and failures (ie. when
+     * RLIMIT_MEMLOCK is exceeded) are counted by lock_failures().
+     *
+     * Locks apply to whole pages and do not nest, so the live allocations on each locked page are
+     * counted in a single process-wide table, shared by every instance, and a page is only unlocked
+     * once none remain (whichever instance made them).
+     *
+     * Note: Use with serializer_t(resource) and deserializer_t(input, resource). Copies made via
+     * serializer_t::vector() or deserializer_t::bytes() are ordinary std::vector and are not wiped.
+     */
+    struct secure_resource_t final : std::pmr::memory_resource
+    {
+        /**
+         * The minimum capacity, in bytes, that a serializer_t backed by a secure_resource_t grows to at once
+         */
+        static constexpr size_t GROWTH = 4096;
+
+        explicit secure_resource_t(
+            bool lock_memory = false,
+            std::pmr::memory_resource *upstream = std::pmr::get_default_resource());
+
+        /**
+         * Returns the number of times locking memory into RAM has failed
+         *
+         * @return
+         */
+        [[nodiscard]] size_t lock_failures() const;
+
+      protected:
+        void *do_allocate(size_t bytes, size_t alignment) override;
+
+        void do_deallocate(void *pointer, size_t bytes, size_t alignment) override;
+
+        [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+      private:
+        /**
+         * Locks the pages spanned by the memory that are not already locked
+         *
+         * @param pointer
+         * @param bytes
+         */
+        void lock(void *pointer, size_t bytes);
+
+        /**
+         * Unlocks the pages spanned by the memory that no other live allocation still uses
+         *
+         * @param pointer
+         * @param bytes
+         */
+        void unlock(void *pointer, size_t bytes);
+
+        bool lock_memory;
+
+        std::pmr::memory_resource *upstream;
+
+        size_t failures = 0;
+    };
+
+    /**
+     * Returns a process-wide secure_resource_t (with or without memory locking) backed by the
+     * new/delete resource
+     *
+     * @param lock_memory
+     * @return
+     */
+    std::pmr::memory_resource *secure_resource(bool lock_memory = false);
+} // namespace Serialization
+
+#endif
@@ -29,6 +29,7 @@
 
 #include <deserializer_t.h>
 #include <json_helper.h>
+#include <secure_arena.h>
 #include <secure_erase.h>
 #include <serializer_t.h>
 #include <string_helper.h>
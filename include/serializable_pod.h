@@ -46,7 +46,11 @@ template<unsigned int SIZE = 32> struct SerializablePod : Serializable
 
     ~SerializablePod()
     {
-        secure_erase(bytes, sizeof(bytes));
+        // pods living in the active secure arena are wiped in bulk by the arena instead
+        if (!Serialization::secure_arena_t::covers(bytes))
+        {
+            secure_erase(bytes, sizeof(bytes));
+        }
     }
 
     /**
@@ -160,9 +164,9 @@ template<unsigned int SIZE = 32> struct SerializablePod : Serializable
      */
     void deserialize(Serialization::deserializer_t &reader) override
     {
-        const auto data = reader.bytes(sizeof(bytes));
+        reader.bytes(bytes, sizeof(bytes));
 
-        deserialize(data);
+        load_hook();
     }
 
     /**
@@ -29,11 +29,22 @@
 
 #include <serializable.h>
 
-template<typename Type> struct SerializableVector : Serializable
+/**
+ * Note: An allocator (ie. std::pmr::polymorphic_allocator<Type>) may be supplied such that
+ * the underlying container is allocated from a specific memory resource (ie. an arena)
+ */
+template<typename Type, typename Allocator = std::allocator<Type>> struct SerializableVector : Serializable
 {
   public:
     SerializableVector() = default;
 
+    /**
+     * Constructs the structure with a container that uses the supplied allocator
+     *
+     * @param allocator
+     */
+    explicit SerializableVector(const Allocator &allocator): container(allocator) {}
+
     JSON_OBJECT_CONSTRUCTOR(SerializableVector, fromJSON);
 
     /**
@@ -56,12 +67,12 @@ template<typename Type> struct SerializableVector : Serializable
         return container[i];
     }
 
-    bool operator==(const SerializableVector<Type> &other) const
+    bool operator==(const SerializableVector<Type, Allocator> &other) const
     {
         return std::equal(container.begin(), container.end(), other.container.begin());
     }
 
-    bool operator!=(const SerializableVector<Type> &other) const
+    bool operator!=(const SerializableVector<Type, Allocator> &other) const
     {
         return !(*this == other);
     }
@@ -93,7 +104,7 @@ template<typename Type> struct SerializableVector : Serializable
      */
     void deserialize(Serialization::deserializer_t &reader) override
     {
-        container = reader.podV<Type>();
+        reader.podV(container);
     }
 
     /**
@@ -113,7 +124,7 @@ template<typename Type> struct SerializableVector : Serializable
      *
      * @param values
      */
-    void extend(const std::vector<Type> &values)
+    template<typename OtherAllocator> void extend(const std::vector<Type, OtherAllocator> &values)
     {
         for (const auto &value : values)
         {
@@ -126,7 +137,7 @@ template<typename Type> struct SerializableVector : Serializable
      *
      * @param value
      */
-    void extend(const SerializableVector<Type> &value)
+    void extend(const SerializableVector<Type, Allocator> &value)
     {
         extend(value.container);
     }
@@ -227,12 +238,14 @@ template<typename Type> struct SerializableVector : Serializable
      */
     [[nodiscard]] std::string to_string() const override
     {
-        const auto data = serialize();
+        auto writer = Serialization::serializer_t();
+
+        serialize(writer);
 
-        return Serialization::to_hex(data.data(), data.size());
+        return writer.to_string();
     }
 
-    std::vector<Type> container = std::vector<Type>();
+    std::vector<Type, Allocator> container;
 
   protected:
     void from_string(const std::string &str)
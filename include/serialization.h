@@ -27,13 +27,25 @@
 #ifndef SERIALIZATION_LIBRARY
 #define SERIALIZATION_LIBRARY
 
+#include <bit_stream.h>
+#include <bitpacking.h>
+#include <buffer_pool.h>
+#include <byte_order.h>
+#include <column_reader.h>
+#include <compression.h>
 #include <deserializer_t.h>
 #include <json_helper.h>
+#include <pod_prefix_set.h>
+#include <record_stream.h>
+#include <rope_deserializer_t.h>
+#include <secure_arena.h>
 #include <secure_erase.h>
+#include <secure_resource.h>
 #include <serializable_pod.h>
 #include <serializable_vector.h>
 #include <serialization_helper.h>
 #include <serializer_t.h>
+#include <streamvbyte.h>
 #include <string_helper.h>
 
 #ifndef ASSERT_SERIALIZABLE
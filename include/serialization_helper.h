@@ -30,12 +30,229 @@
 #include <algorithm>
 #include <cstdint>
 #include <cstring>
+#include <limits>
 #include <stdexcept>
 #include <tuple>
+#include <type_traits>
+#include <uint256_t/uint128_t.h>
+#include <uint256_t/uint256_t.h>
 #include <vector>
 
+#ifdef _MSC_VER
+#include <stdlib.h>
+#endif
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define SERIALIZATION_BIG_ENDIAN_HOST
+#endif
+
+/**
+ * The marker bytes that lead each sparse pod (see serializer_t::pod_sparse): every byte is zero, the bytes
+ * follow in full, or a bitmap of the non-zero bytes follows along with only those bytes
+ */
+#define SPARSE_POD_EMPTY 0
+#define SPARSE_POD_DENSE 1
+#define SPARSE_POD_BITMAP 2
+
 namespace Serialization
 {
+    /**
+     * Reverses the byte order of the value
+     * @param value
+     * @return
+     */
+    inline uint64_t byteswap64(uint64_t value)
+    {
+#if defined(_MSC_VER)
+        return _byteswap_uint64(value);
+#elif defined(__GNUC__) || defined(__clang__)
+        return __builtin_bswap64(value);
+#else
+        value = ((value & 0x00ff00ff00ff00ffull) << 8) | ((value >> 8) & 0x00ff00ff00ff00ffull);
+
+        value = ((value & 0x0000ffff0000ffffull) << 16) | ((value >> 16) & 0x0000ffff0000ffffull);
+
+        return (value << 32) | (value >> 32);
+#endif
+    }
+
+    /**
+     * Whether the type is one of the multi-limb integer types
+     * @tparam Type
+     */
+    template<typename Type>
+    constexpr bool is_wide_integer_v = std::is_same_v<Type, uint128_t> || std::is_same_v<Type, uint256_t>;
+
+    /**
+     * Returns whether every byte of the data is zero, checking a word at a time
+     * @param data
+     * @param length
+     * @return
+     */
+    inline bool is_zero(const void *data, size_t length)
+    {
+        const auto bytes = static_cast<const unsigned char *>(data);
+
+        uint64_t combined = 0;
+
+        size_t i = 0;
+
+        for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t))
+        {
+            uint64_t word;
+
+            std::memcpy(&word, bytes + i, sizeof(word));
+
+            combined |= word;
+        }
+
+        for (; i < length; ++i)
+        {
+            combined |= bytes[i];
+        }
+
+        return combined == 0;
+    }
+
+    /**
+     * Returns the number of 64-bit limbs that make up a value of the type
+     * @tparam Type
+     * @return
+     */
+    template<typename Type> constexpr size_t limb_count()
+    {
+        if constexpr (std::is_same_v<Type, uint256_t>)
+        {
+            return 4;
+        }
+        else if constexpr (std::is_same_v<Type, uint128_t>)
+        {
+            return 2;
+        }
+        else
+        {
+            static_assert(std::is_integral_v<Type> && sizeof(Type) <= sizeof(uint64_t), "unsupported integer type");
+
+            return 1;
+        }
+    }
+
+    /**
+     * Splits the value into its 64-bit limbs, least significant first
+     * @tparam Type
+     * @param value
+     * @param limbs
+     */
+    template<typename Type> void to_limbs(const Type &value, uint64_t *limbs)
+    {
+        if constexpr (std::is_same_v<Type, uint256_t>)
+        {
+            limbs[0] = value.lower().lower();
+
+            limbs[1] = value.lower().upper();
+
+            limbs[2] = value.upper().lower();
+
+            limbs[3] = value.upper().upper();
+        }
+        else if constexpr (std::is_same_v<Type, uint128_t>)
+        {
+            limbs[0] = value.lower();
+
+            limbs[1] = value.upper();
+        }
+        else
+        {
+            limbs[0] = uint64_t(value);
+        }
+    }
+
+    /**
+     * Reassembles a value from its 64-bit limbs, least significant first
+     * @tparam Type
+     * @param limbs
+     * @return
+     */
+    template<typename Type> Type from_limbs(const uint64_t *limbs)
+    {
+        if constexpr (std::is_same_v<Type, uint256_t>)
+        {
+            return uint256_t(uint128_t(limbs[3], limbs[2]), uint128_t(limbs[1], limbs[0]));
+        }
+        else if constexpr (std::is_same_v<Type, uint128_t>)
+        {
+            return uint128_t(limbs[1], limbs[0]);
+        }
+        else
+        {
+            return Type(limbs[0]);
+        }
+    }
+
+    /**
+     * Writes the limbs of the value to the output, which must have room for limb_count<Type>() * 8 bytes,
+     * as a single little-endian (least significant limb first) or big-endian (most significant limb
+     * first) number
+     * @tparam Type
+     * @param value
+     * @param output
+     * @param big_endian
+     */
+    template<typename Type> void pack_limbs(const Type &value, unsigned char *output, bool big_endian = false)
+    {
+        constexpr auto count = limb_count<Type>();
+
+        uint64_t limbs[count];
+
+        to_limbs(value, limbs);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto limb = limbs[i];
+
+#ifdef SERIALIZATION_BIG_ENDIAN_HOST
+            if (!big_endian)
+#else
+            if (big_endian)
+#endif
+            {
+                limb = byteswap64(limb);
+            }
+
+            std::memcpy(output + (big_endian ? count - 1 - i : i) * sizeof(uint64_t), &limb, sizeof(uint64_t));
+        }
+    }
+
+    /**
+     * Reads a value written by pack_limbs() from the input, which must hold limb_count<Type>() * 8 bytes
+     * @tparam Type
+     * @param input
+     * @param big_endian
+     * @return
+     */
+    template<typename Type> Type unpack_limbs(const unsigned char *input, bool big_endian = false)
+    {
+        constexpr auto count = limb_count<Type>();
+
+        uint64_t limbs[count];
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            std::memcpy(&limbs[i], input + (big_endian ? count - 1 - i : i) * sizeof(uint64_t), sizeof(uint64_t));
+
+#ifdef SERIALIZATION_BIG_ENDIAN_HOST
+            if (!big_endian)
+#else
+            if (big_endian)
+#endif
+            {
+                limbs[i] = byteswap64(limbs[i]);
+            }
+        }
+
+        return from_limbs<Type>(limbs);
+    }
+
     /**
      * Packs the provided value into a byte vector
      * @tparam Type
@@ -45,6 +262,15 @@ namespace Serialization
      */
     template<typename Type> std::vector<unsigned char> pack(const Type &value, bool big_endian = false)
     {
+        if constexpr (is_wide_integer_v<Type>)
+        {
+            std::vector<unsigned char> result(limb_count<Type>() * sizeof(uint64_t));
+
+            pack_limbs(value, result.data(), big_endian);
+
+            return result;
+        }
+
         unsigned char bytes[64] = {0};
 
         std::memcpy(&bytes, &value, sizeof(Type));
@@ -60,124 +286,399 @@ namespace Serialization
     }
 
     /**
-     * Unpacks a value from the provided byte vector starting at the given offset
+     * Unpacks a value from the provided byte array of the given length starting at the given offset
      * @tparam Type
      * @param packed
+     * @param length
      * @param offset
      * @param big_endian
      * @return
      */
     template<typename Type>
-    Type unpack(const std::vector<unsigned char> &packed, size_t offset = 0, bool big_endian = false)
+    Type unpack(const unsigned char *packed, size_t length, size_t offset = 0, bool big_endian = false)
     {
         const auto size = sizeof(Type);
 
-        if (offset + size > packed.size())
+        if (offset > length || size > length - offset)
         {
             throw std::range_error("not enough data to complete request");
         }
 
-        std::vector<unsigned char> bytes(size, 0);
-
-        for (size_t i = offset, j = 0; i < offset + size; ++i, ++j)
+        if constexpr (is_wide_integer_v<Type>)
         {
-            bytes[j] = packed[i];
+            return unpack_limbs<Type>(packed + offset, big_endian);
         }
 
-        Type value = 0;
+        unsigned char bytes[sizeof(Type)];
+
+        std::memcpy(bytes, packed + offset, size);
 
         if (big_endian)
         {
-            std::reverse(bytes.begin(), bytes.end());
+            std::reverse(bytes, bytes + size);
         }
 
-        std::memcpy(&value, bytes.data(), bytes.size());
+        Type value = 0;
+
+        std::memcpy(&value, bytes, size);
 
         return value;
     }
 
+    /**
+     * Unpacks a value from the provided byte vector starting at the given offset
+     * @tparam Type
+     * @param packed
+     * @param offset
+     * @param big_endian
+     * @return
+     */
+    template<typename Type>
+    Type unpack(const std::vector<unsigned char> &packed, size_t offset = 0, bool big_endian = false)
+    {
+        return unpack<Type>(packed.data(), packed.size(), offset, big_endian);
+    }
+
+    /**
+     * Returns the maximum number of bytes that a varint of the type occupies
+     * @tparam Type
+     * @return
+     */
+    template<typename Type> constexpr size_t varint_max_length()
+    {
+        return std::max(sizeof(Type) + 2, (limb_count<Type>() * 64 + 6) / 7);
+    }
+
     /**
      * Encodes a value into a varint byte vector
+     *
+     * Note: Values of uint128_t and uint256_t are encoded limb-wise such that small values take only
+     * as many bytes as their significant bits require
+     *
      * @tparam Type
      * @param value
      * @return
      */
     template<typename Type> std::vector<unsigned char> encode_varint(const Type &value)
     {
-        const auto max_length = sizeof(Type) + 2;
+        if constexpr (limb_count<Type>() > 1)
+        {
+            constexpr auto count = limb_count<Type>();
 
-        std::vector<unsigned char> output;
+            uint64_t limbs[count];
 
-        Type val = value;
+            to_limbs(value, limbs);
 
-        while (val >= 0x80)
-        {
-            if (output.size() == (max_length - 1))
+            auto top = count;
+
+            while (top > 1 && limbs[top - 1] == 0)
             {
-                throw std::range_error("value is out of range for type");
+                top--;
             }
 
-            const auto val8 = static_cast<unsigned char>(val);
+            // the common case of a small wide value is no different from a uint64_t
+            if (top == 1)
+            {
+                return encode_varint(limbs[0]);
+            }
+
+            std::vector<unsigned char> output;
+
+            output.reserve((top * 64 + 6) / 7);
+
+            while (top > 1 || limbs[0] >= 0x80)
+            {
+                output.push_back(static_cast<unsigned char>(limbs[0] & 0x7f) | 0x80);
+
+                // shift the significant limbs right by seven bits
+                for (size_t i = 0; i + 1 < top; ++i)
+                {
+                    limbs[i] = (limbs[i] >> 7) | (limbs[i + 1] << 57);
+                }
 
-            output.push_back((static_cast<unsigned char>(val8) & 0x7f) | 0x80);
+                limbs[top - 1] >>= 7;
 
-            val >>= 7;
+                if (top > 1 && limbs[top - 1] == 0)
+                {
+                    top--;
+                }
+            }
+
+            output.push_back(static_cast<unsigned char>(limbs[0]));
+
+            return output;
         }
+        else
+        {
+            const auto max_length = varint_max_length<Type>();
+
+            std::vector<unsigned char> output;
+
+            Type val = value;
+
+            while (val >= 0x80)
+            {
+                if (output.size() == (max_length - 1))
+                {
+                    throw std::range_error("value is out of range for type");
+                }
+
+                const auto val8 = static_cast<unsigned char>(val);
 
-        const auto val8 = static_cast<unsigned char>(val);
+                output.push_back((static_cast<unsigned char>(val8) & 0x7f) | 0x80);
 
-        output.push_back(static_cast<unsigned char>(val8));
+                val >>= 7;
+            }
+
+            const auto val8 = static_cast<unsigned char>(val);
 
-        return output;
+            output.push_back(static_cast<unsigned char>(val8));
+
+            return output;
+        }
     }
 
     /**
-     * Decodes a value from the provided varint byte vector starting at the given offset
+     * Decodes a value from the provided varint byte array of the given length starting at the given offset
+     *
+     * Note: The value is accumulated limb-wise, such that uint128_t and uint256_t values decode exactly,
+     * and any bits beyond the width of the type are rejected
+     *
      * @tparam Type
      * @param packed
+     * @param length
      * @param offset
      * @return
      */
     template<typename Type>
-    std::tuple<Type, size_t> decode_varint(const std::vector<unsigned char> &packed, const size_t offset = 0)
+    std::tuple<Type, size_t> decode_varint(const unsigned char *packed, size_t length, const size_t offset = 0)
     {
-        if (offset > packed.size())
+        if (offset > length)
         {
             throw std::range_error("offset exceeds sizes of vector");
         }
 
-        auto counter = offset;
+        constexpr auto count = limb_count<Type>();
 
-        auto shift = 0;
+        uint64_t limbs[count] = {};
 
-        Type temp_result = 0;
+        auto counter = offset;
+
+        size_t shift = 0;
 
         unsigned char b;
 
         do
         {
-            if (counter >= packed.size())
+            if (counter >= length)
             {
                 throw std::range_error("could not decode varint");
             }
 
             b = packed[counter++];
 
-            const auto value = (shift < 28) ? uint64_t(b & 0x7f) << shift : uint64_t(b & 0x7f) * (uint64_t(1) << shift);
+            const auto value = uint64_t(b & 0x7f);
 
-            temp_result += Type(value);
+            const auto limb = shift / 64, bit = shift % 64;
+
+            if (limb < count)
+            {
+                limbs[limb] |= value << bit;
+
+                // the group straddles two limbs, carry its upper bits into the next one
+                if (bit > 57)
+                {
+                    const auto carry = value >> (64 - bit);
+
+                    if (limb + 1 < count)
+                    {
+                        limbs[limb + 1] |= carry;
+                    }
+                    else if (carry != 0)
+                    {
+                        throw std::range_error("value is out of range for type");
+                    }
+                }
+            }
+            else if (value != 0)
+            {
+                throw std::range_error("value is out of range for type");
+            }
 
             shift += 7;
         } while (b >= 0x80);
 
-        const auto result = Type(temp_result);
+        if constexpr (count == 1)
+        {
+            if (limbs[0] > uint64_t(std::numeric_limits<Type>::max()))
+            {
+                throw std::range_error("value is out of range for type");
+            }
+        }
+
+        return {from_limbs<Type>(limbs), counter - offset};
+    }
+
+    /**
+     * Decodes a value from the provided varint byte vector starting at the given offset
+     * @tparam Type
+     * @param packed
+     * @param offset
+     * @return
+     */
+    template<typename Type>
+    std::tuple<Type, size_t> decode_varint(const std::vector<unsigned char> &packed, const size_t offset = 0)
+    {
+        return decode_varint<Type>(packed.data(), packed.size(), offset);
+    }
+
+    /**
+     * Maps a signed value onto an unsigned value such that values of small magnitude, whether
+     * positive or negative, map to small values (0, -1, 1, -2, 2, ... => 0, 1, 2, 3, 4, ...)
+     * @tparam Type
+     * @param value
+     * @return
+     */
+    template<typename Type> std::make_unsigned_t<Type> zigzag_encode(const Type &value)
+    {
+        static_assert(std::is_integral_v<Type> && std::is_signed_v<Type>, "zigzag encoding requires a signed type");
+
+        using Unsigned = std::make_unsigned_t<Type>;
+
+        // the arithmetic right shift smears the sign bit across the entire value
+        return static_cast<Unsigned>(static_cast<Unsigned>(value) << 1)
+               ^ static_cast<Unsigned>(value >> (sizeof(Type) * 8 - 1));
+    }
+
+    /**
+     * Reverses the mapping performed by zigzag_encode()
+     * @tparam Type
+     * @param value
+     * @return
+     */
+    template<typename Type> Type zigzag_decode(const std::make_unsigned_t<Type> &value)
+    {
+        static_assert(std::is_integral_v<Type> && std::is_signed_v<Type>, "zigzag decoding requires a signed type");
+
+        using Unsigned = std::make_unsigned_t<Type>;
+
+        return static_cast<Type>(static_cast<Unsigned>(value >> 1) ^ static_cast<Unsigned>(0 - (value & 1)));
+    }
+
+    /**
+     * Encodes a signed value into a zigzag mapped varint byte vector
+     * @tparam Type
+     * @param value
+     * @return
+     */
+    template<typename Type> std::vector<unsigned char> encode_svarint(const Type &value)
+    {
+        return encode_varint(zigzag_encode(value));
+    }
+
+    /**
+     * Decodes a signed value from the provided zigzag mapped varint byte array of the given length
+     * starting at the given offset
+     * @tparam Type
+     * @param packed
+     * @param length
+     * @param offset
+     * @return
+     */
+    template<typename Type>
+    std::tuple<Type, size_t> decode_svarint(const unsigned char *packed, size_t length, const size_t offset = 0)
+    {
+        const auto [value, count] = decode_varint<std::make_unsigned_t<Type>>(packed, length, offset);
+
+        return {zigzag_decode<Type>(value), count};
+    }
 
-        if (result != temp_result)
+    /**
+     * Decodes a signed value from the provided zigzag mapped varint byte vector starting at the given offset
+     * @tparam Type
+     * @param packed
+     * @param offset
+     * @return
+     */
+    template<typename Type>
+    std::tuple<Type, size_t> decode_svarint(const std::vector<unsigned char> &packed, const size_t offset = 0)
+    {
+        return decode_svarint<Type>(packed.data(), packed.size(), offset);
+    }
+
+    /**
+     * Decodes count delta encoded varints from the provided byte array of the given length starting at
+     * the given offset into the output, reconstructing each value as the running sum of the deltas
+     * and the supplied initial value
+     *
+     * Note: One and two byte deltas, which dominate densely sorted data, are decoded without entering
+     * the general varint loop
+     *
+     * @tparam Type
+     * @param packed
+     * @param length
+     * @param offset
+     * @param output
+     * @param count
+     * @param initial
+     * @return the number of bytes consumed
+     */
+    template<typename Type>
+    size_t decode_delta_varints(
+        const unsigned char *packed,
+        size_t length,
+        size_t offset,
+        Type *output,
+        size_t count,
+        Type initial = 0)
+    {
+        static_assert(std::is_unsigned_v<Type>, "delta decoding requires an unsigned integer type");
+
+        if (offset > length)
+        {
+            throw std::range_error("offset exceeds sizes of vector");
+        }
+
+        auto position = offset;
+
+        auto previous = initial;
+
+        for (size_t i = 0; i < count; ++i)
         {
-            throw std::range_error("value is out of range for type");
+            Type delta;
+
+            if (position < length && packed[position] < 0x80)
+            {
+                delta = packed[position++];
+            }
+            else if (sizeof(Type) > 1 && position + 1 < length && packed[position + 1] < 0x80)
+            {
+                delta = Type(packed[position] & 0x7f) | Type(Type(packed[position + 1]) << 7);
+
+                position += 2;
+            }
+            else
+            {
+                const auto [value, consumed] = decode_varint<Type>(packed, length, position);
+
+                delta = value;
+
+                position += consumed;
+            }
+
+            const Type current = previous + delta;
+
+            if (current < previous)
+            {
+                throw std::range_error("value is out of range for type");
+            }
+
+            output[i] = current;
+
+            previous = current;
         }
 
-        return {result, counter - offset};
+        return position - offset;
     }
 
 } // namespace Serialization
@@ -27,16 +27,45 @@
 #ifndef SERIALIZATION_SERIALIZER_T
 #define SERIALIZATION_SERIALIZER_T
 
+#include <bitpacking.h>
+#include <buffer_pool.h>
+#include <compression.h>
+#include <memory_resource>
 #include <serialization_helper.h>
+#include <streamvbyte.h>
 #include <string_helper.h>
+#include <string_view>
 #include <uint256_t/uint128_t.h>
 #include <uint256_t/uint256_t.h>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <sys/uio.h>
+#endif
 
 namespace Serialization
 {
+    /**
+     * Describes a contiguous region of memory that makes up part of the output of a serializer_t
+     */
+    struct buffer_segment_t
+    {
+        const unsigned char *data;
+
+        size_t length;
+    };
+
+    /**
+     * Note: In gather mode (see gather_threshold()), calls to bytes() at or above the threshold do not
+     * copy the supplied data; instead, a reference to the caller's memory is recorded as its own segment
+     * of the output. The referenced memory MUST remain valid and unmodified until the output has been
+     * consumed (ie. via segments(), iovecs(), vector(), or deserializer_t) or the writer has been reset.
+     * In gather mode, data(), operator[] and the backing byte vector only cover the inline (copied) bytes;
+     * size() always reports the full length of the output.
+     */
     struct serializer_t final
     {
-        serializer_t() = default;
+        serializer_t();
 
         serializer_t(const serializer_t &writer);
 
@@ -44,16 +73,122 @@ namespace Serialization
 
         explicit serializer_t(const std::vector<unsigned char> &input);
 
+        /**
+         * Constructs the writer such that its underlying byte vector is allocated from the supplied resource
+         *
+         * @param resource
+         */
+        explicit serializer_t(std::pmr::memory_resource *resource);
+
+        ~serializer_t();
+
         unsigned char &operator[](int i);
 
         unsigned char operator[](int i) const;
 
+        /**
+         * Begins a length-prefixed nested structure by reserving space for its length prefix
+         * such that the body can be written in place and the prefix backpatched by end_nested()
+         *
+         * Note: By default the prefix is a varint (identical to writing varint(length) followed
+         * by the body) for which a single byte is reserved; if the final length requires a longer
+         * varint, the body is shifted once. If fixed_width is set, the prefix is always a 4-byte
+         * uint32 and the body is never shifted.
+         *
+         * @param fixed_width
+         */
+        void begin_nested(bool fixed_width = false);
+
+        /**
+         * Encodes the vector of values into the vector using frame of reference bit packing: each full
+         * block of BITPACKING_BLOCK_SIZE values is written as the varint of its minimum, the bit width
+         * of its range, and the offsets of its values from the minimum packed at that width
+         *
+         * Note: The trailing partial block is written as plain varints and blocks whose range exceeds
+         * 32 bits are written as raw 64-bit offsets
+         *
+         * @tparam Type
+         * @param values
+         */
+        template<typename Type, typename Allocator> void bitpacked(const std::vector<Type, Allocator> &values)
+        {
+            static_assert(
+                std::is_unsigned_v<Type> && sizeof(Type) <= sizeof(uint64_t),
+                "bit packing requires an unsigned integer type of at most 64 bits");
+
+            varint(values.size());
+
+            uint32_t offsets[BITPACKING_BLOCK_SIZE];
+
+            size_t i = 0;
+
+            for (; i + BITPACKING_BLOCK_SIZE <= values.size(); i += BITPACKING_BLOCK_SIZE)
+            {
+                const auto block = values.begin() + i;
+
+                Type minimum = block[0], maximum = block[0];
+
+                // a branch-free reduction, unlike std::minmax_element, vectorizes
+                for (size_t j = 1; j < BITPACKING_BLOCK_SIZE; ++j)
+                {
+                    minimum = std::min(minimum, block[j]);
+
+                    maximum = std::max(maximum, block[j]);
+                }
+
+                const auto low = uint64_t(minimum), range = uint64_t(maximum) - low;
+
+                varint(low);
+
+                if (range > UINT32_MAX)
+                {
+                    uint8(64);
+
+                    for (size_t j = 0; j < BITPACKING_BLOCK_SIZE; ++j)
+                    {
+                        uint64(uint64_t(block[j]) - low);
+                    }
+
+                    continue;
+                }
+
+                const auto width = BitPacking::width(range);
+
+                uint8(width);
+
+                for (size_t j = 0; j < BITPACKING_BLOCK_SIZE; ++j)
+                {
+                    offsets[j] = uint32_t(uint64_t(block[j]) - low);
+                }
+
+                const auto position = buffer.size();
+
+                grow(BitPacking::packed_size(width));
+
+                buffer.resize(position + BitPacking::packed_size(width));
+
+                BitPacking::pack(offsets, width, buffer.data() + position);
+            }
+
+            for (; i < values.size(); ++i)
+            {
+                varint(values[i]);
+            }
+        }
+
         /**
          * Encodes the value into the vector
          * @param value
          */
         void boolean(bool value);
 
+        /**
+         * Encodes the vector of values into the vector as the count followed by one bit per value,
+         * least significant bit first, with the final byte padded with zero bits
+         * @param values
+         */
+        void boolean(const std::vector<bool> &values);
+
         /**
          * Encodes the value into the vector
          * @param data
@@ -67,18 +202,106 @@ namespace Serialization
          */
         void bytes(const std::vector<unsigned char> &value);
 
+        /**
+         * Encodes the vector of records into the vector as one column per given field, such that each field
+         * of every record is stored contiguously: unsigned integer fields are bit packed, signed integer
+         * fields are zigzag mapped then bit packed, boolean fields are stored as a bit set, other trivially
+         * copyable fields are stored as their in-memory bytes, and any other field is stored via its
+         * serialize() method (ie. SerializablePod). Each column is length-prefixed so that a
+         * column_reader_t can decode only the columns it needs.
+         *
+         * @tparam Record
+         * @tparam Fields
+         * @param records
+         * @param fields pointers to the members of the record to store, in column order
+         */
+        template<typename Record, typename Allocator, typename... Fields>
+        void columns(const std::vector<Record, Allocator> &records, Fields Record::*...fields)
+        {
+            static_assert(sizeof...(Fields) != 0, "at least one column is required");
+
+            varint(records.size());
+
+            varint(sizeof...(Fields));
+
+            (column(records, fields), ...);
+        }
+
+        /**
+         * Returns the output compressed as a series of independently decodable chunks of at most the given
+         * number of uncompressed bytes each (see Compression), which may be read back incrementally via
+         * decompressor_t
+         *
+         * @param chunk_size
+         * @return
+         */
+        [[nodiscard]] std::vector<unsigned char> compressed(size_t chunk_size = COMPRESSION_CHUNK_SIZE) const;
+
         /**
          * Returns a pointer to the underlying structure data
          * @return
          */
         [[nodiscard]] const unsigned char *data() const;
 
+        /**
+         * Encodes the sorted vector of values into the vector as the count followed by the varint
+         * encoded difference of each value from the one before it (the first from zero)
+         *
+         * Note: Throws if the values are not sorted in ascending order
+         *
+         * @tparam Type
+         * @param values
+         */
+        template<typename Type, typename Allocator> void delta_varint(const std::vector<Type, Allocator> &values)
+        {
+            static_assert(std::is_unsigned_v<Type>, "delta encoding requires an unsigned integer type");
+
+            // check the order up front so that nothing is written when the values are rejected
+            if (!std::is_sorted(values.begin(), values.end()))
+            {
+                throw std::invalid_argument("values must be sorted in ascending order");
+            }
+
+            varint(values.size());
+
+            Type previous = 0;
+
+            for (const auto &value : values)
+            {
+                varint(Type(value - previous));
+
+                previous = value;
+            }
+        }
+
+        /**
+         * Completes the most recently begun nested structure by backpatching its length prefix
+         */
+        void end_nested();
+
+        /**
+         * Enables gather mode such that calls to bytes() with a length at or above the threshold
+         * record a reference to the caller's memory instead of copying it (0 disables gather mode)
+         *
+         * @param value
+         */
+        void gather_threshold(size_t value);
+
         /**
          * Encodes the value into the vector
          * @param value
          */
         void hex(const std::string &value);
 
+#ifndef _WIN32
+        /**
+         * Returns the output as an iovec array suitable for use with writev()
+         *
+         * @return
+         */
+        [[nodiscard]] std::vector<struct iovec> iovecs() const;
+#endif
+
         /**
          * Encodes the value into the vector
          *
@@ -96,7 +319,7 @@ namespace Serialization
          *
          * @param values
          */
-        template<typename Type> void pod(const std::vector<Type> &values)
+        template<typename Type, typename Allocator> void pod(const std::vector<Type, Allocator> &values)
         {
             varint(values.size());
 
@@ -111,7 +334,8 @@ namespace Serialization
          *
          * @param values
          */
-        template<typename Type> void pod(const std::vector<std::vector<Type>> &values)
+        template<typename Type, typename Allocator, typename OuterAllocator>
+        void pod(const std::vector<std::vector<Type, Allocator>, OuterAllocator> &values)
         {
             varint(values.size());
 
@@ -126,11 +350,205 @@ namespace Serialization
             }
         }
 
+        /**
+         * Encodes the vector of values into the vector using dictionary encoding: the count of unique
+         * values followed by each unique value (in order of first occurrence), then the count of values
+         * followed by the varint index of each value within the dictionary
+         *
+         * Note: Intended for vectors that repeat the same values many times; every value must expose
+         * its bytes via data() and size() (ie. SerializablePod)
+         *
+         * @tparam Type
+         * @param values
+         */
+        template<typename Type, typename Allocator> void pod_dictionary(const std::vector<Type, Allocator> &values)
+        {
+            std::unordered_map<std::string_view, size_t> positions;
+
+            positions.reserve(values.size());
+
+            std::vector<const Type *> dictionary;
+
+            std::vector<size_t> indices;
+
+            indices.reserve(values.size());
+
+            for (const auto &value : values)
+            {
+                const auto key = std::string_view(reinterpret_cast<const char *>(value.data()), value.size());
+
+                const auto [position, inserted] = positions.try_emplace(key, dictionary.size());
+
+                if (inserted)
+                {
+                    dictionary.push_back(&value);
+                }
+
+                indices.push_back(position->second);
+            }
+
+            varint(dictionary.size());
+
+            for (const auto &value : dictionary)
+            {
+                pod<Type>(*value);
+            }
+
+            varint(indices);
+        }
+
+        /**
+         * Encodes the sorted vector of values into the vector using front coding: each value is written
+         * as the number of bytes it shares with the value before it followed by the bytes it does not
+         * share, with every interval-th value (a restart point) written in full. The entries are followed
+         * by the offset of every restart point such that pod_prefix_set_t can binary search them.
+         *
+         * Note: Values must be sorted in ascending order and expose their bytes via data() and size()
+         * (ie. SerializablePod); as SerializablePod orders by its last byte first, the shared bytes are
+         * counted from the end of each value.
+         *
+         * @tparam Type
+         * @param values
+         * @param interval
+         */
+        template<typename Type, typename Allocator>
+        void pod_prefix(const std::vector<Type, Allocator> &values, size_t interval = 16)
+        {
+            if (interval == 0)
+            {
+                throw std::invalid_argument("restart interval must be greater than zero");
+            }
+
+            // validate the order and lay out the entries before anything is written, such that a failure
+            // leaves the writer untouched
+            std::vector<size_t> shared(values.size(), 0);
+
+            std::vector<uint32_t> restarts;
+
+            uint64_t position = 0;
+
+            for (size_t i = 0; i < values.size(); ++i)
+            {
+                const auto width = values[i].size();
+
+                // restart entries are compared too, as the restart binary search relies on the order
+                if (i != 0 && values[i] < values[i - 1])
+                {
+                    throw std::invalid_argument("values must be sorted in ascending order");
+                }
+
+                if (i % interval == 0)
+                {
+                    if (position > UINT32_MAX)
+                    {
+                        throw std::range_error("front coded entries too large for restart offsets");
+                    }
+
+                    restarts.push_back(static_cast<uint32_t>(position));
+                }
+                else
+                {
+                    const auto current = values[i].data(), previous = values[i - 1].data();
+
+                    while (shared[i] < width && current[width - 1 - shared[i]] == previous[width - 1 - shared[i]])
+                    {
+                        shared[i]++;
+                    }
+                }
+
+                // the varint of the shared length followed by the bytes that are not shared
+                for (auto remaining = shared[i] >> 7; remaining != 0; remaining >>= 7)
+                {
+                    position++;
+                }
+
+                position += 1 + width - shared[i];
+            }
+
+            varint(values.size());
+
+            varint(interval);
+
+            begin_nested();
+
+            for (size_t i = 0; i < values.size(); ++i)
+            {
+                varint(shared[i]);
+
+                bytes(values[i].data(), values[i].size() - shared[i]);
+            }
+
+            end_nested();
+
+            uint32(restarts.data(), restarts.size());
+        }
+
+        /**
+         * Encodes the value into the vector as a sparse pod: a single marker byte if every byte of the
+         * value is zero, otherwise a bitmap of its non-zero bytes followed by only those bytes if that is
+         * smaller than the value itself, otherwise the value in full
+         *
+         * @tparam Type
+         * @param value
+         */
+        template<typename Type> void pod_sparse(const Type &value)
+        {
+            sparse(value.data(), value.size());
+        }
+
+        /**
+         * Encodes the vector of values into the vector as sparse pods
+         *
+         * @tparam Type
+         * @param values
+         */
+        template<typename Type, typename Allocator> void pod_sparse(const std::vector<Type, Allocator> &values)
+        {
+            varint(values.size());
+
+            for (const auto &value : values)
+            {
+                sparse(value.data(), value.size());
+            }
+        }
+
+        /**
+         * Reserves capacity in the underlying byte vector for at least the given number of bytes
+         *
+         * @param capacity
+         */
+        void reserve(size_t capacity);
+
         /**
          * Clears the underlying byte vector
          */
         void reset();
 
+        /**
+         * Returns the memory resource from which the underlying byte vector is allocated
+         *
+         * @return
+         */
+        [[nodiscard]] std::pmr::memory_resource *resource() const;
+
+        /**
+         * Returns the output as an ordered list of contiguous memory segments; inline (copied) bytes
+         * and gathered references to caller memory are interleaved in the order they were written
+         *
+         * @return
+         */
+        [[nodiscard]] std::vector<buffer_segment_t> segments() const;
+
+        /**
+         * Wipes the entire capacity of the underlying byte vector before clearing it
+         *
+         * Note: To keep copies of secrets from being left behind as the byte vector grows, construct
+         * the writer with a secure_resource(); such writers grow in large geometric steps (of at least
+         * secure_resource_t::GROWTH bytes) to limit the number of reallocations, and reserve() can be used
+         * to allocate the expected size up front
+         */
+        void secure_reset();
+
         /**
          * Use this method instead of sizeof() to get the resulting
          * size of the structure in bytes
@@ -138,6 +556,76 @@ namespace Serialization
          */
         [[nodiscard]] size_t size() const;
 
+        /**
+         * Encodes the vector of values into the vector in the Stream VByte layout: the count, followed by
+         * a 2-bit byte length for each value packed four to a control byte, followed by the significant
+         * little-endian bytes of each value
+         *
+         * Note: Unlike varint(), the position of every value is known from the control bytes alone, which
+         * allows streamvbyteV() to decode four values at a time
+         *
+         * @tparam Type
+         * @param values
+         */
+        template<typename Type, typename Allocator> void streamvbyte(const std::vector<Type, Allocator> &values)
+        {
+            static_assert(
+                std::is_unsigned_v<Type> && sizeof(Type) <= sizeof(uint32_t),
+                "stream vbyte requires an unsigned integer type of at most 32 bits");
+
+            varint(values.size());
+
+            const auto position = buffer.size(), control_length = StreamVByte::control_size(values.size());
+
+            grow(control_length + values.size() * sizeof(uint32_t));
+
+            buffer.resize(position + control_length + values.size() * sizeof(uint32_t));
+
+            const auto control = buffer.data() + position;
+
+            size_t length;
+
+            if constexpr (std::is_same_v<Type, uint32_t>)
+            {
+                length = StreamVByte::encode(values.data(), values.size(), control, control + control_length);
+            }
+            else
+            {
+                const auto widened = std::vector<uint32_t>(values.begin(), values.end());
+
+                length = StreamVByte::encode(widened.data(), widened.size(), control, control + control_length);
+            }
+
+            buffer.resize(position + control_length + length);
+        }
+
+        /**
+         * Encodes the signed value into the vector as a zigzag mapped varint
+         * @tparam Type
+         * @param value
+         */
+        template<typename Type> void svarint(const Type &value)
+        {
+            const auto bytes = encode_svarint(value);
+
+            extend(bytes);
+        }
+
+        /**
+         * Encodes the vector of signed values into the vector as zigzag mapped varints
+         * @tparam Type
+         * @param values
+         */
+        template<typename Type, typename Allocator> void svarint(const std::vector<Type, Allocator> &values)
+        {
+            varint(values.size());
+
+            for (const auto &value : values)
+            {
+                svarint(value);
+            }
+        }
+
         /**
          * Returns the hex encoding of the underlying byte vector
          * @return
@@ -157,6 +645,28 @@ namespace Serialization
          */
         void uint16(const uint16_t &value, bool big_endian = false);
 
+        /**
+         * Encodes the given number of values into the vector at their fixed width, without a length prefix
+         * @param values
+         * @param count
+         * @param big_endian
+         */
+        void uint16(const uint16_t *values, size_t count, bool big_endian = false);
+
+        /**
+         * Encodes the vector of values into the vector as the count followed by each value at its
+         * fixed width
+         * @param values
+         * @param big_endian
+         */
+        template<typename Allocator>
+        void uint16(const std::vector<uint16_t, Allocator> &values, bool big_endian = false)
+        {
+            varint(values.size());
+
+            uint16(values.data(), values.size(), big_endian);
+        }
+
         /**
          * Encodes the value into the vector
          * @param value
@@ -164,6 +674,28 @@ namespace Serialization
          */
         void uint32(const uint32_t &value, bool big_endian = false);
 
+        /**
+         * Encodes the given number of values into the vector at their fixed width, without a length prefix
+         * @param values
+         * @param count
+         * @param big_endian
+         */
+        void uint32(const uint32_t *values, size_t count, bool big_endian = false);
+
+        /**
+         * Encodes the vector of values into the vector as the count followed by each value at its
+         * fixed width
+         * @param values
+         * @param big_endian
+         */
+        template<typename Allocator>
+        void uint32(const std::vector<uint32_t, Allocator> &values, bool big_endian = false)
+        {
+            varint(values.size());
+
+            uint32(values.data(), values.size(), big_endian);
+        }
+
         /**
          * Encodes the value into the vector
          * @param value
@@ -171,6 +703,28 @@ namespace Serialization
          */
         void uint64(const uint64_t &value, bool big_endian = false);
 
+        /**
+         * Encodes the given number of values into the vector at their fixed width, without a length prefix
+         * @param values
+         * @param count
+         * @param big_endian
+         */
+        void uint64(const uint64_t *values, size_t count, bool big_endian = false);
+
+        /**
+         * Encodes the vector of values into the vector as the count followed by each value at its
+         * fixed width
+         * @param values
+         * @param big_endian
+         */
+        template<typename Allocator>
+        void uint64(const std::vector<uint64_t, Allocator> &values, bool big_endian = false)
+        {
+            varint(values.size());
+
+            uint64(values.data(), values.size(), big_endian);
+        }
+
         /**
          * Encodes the value into the vector
          * @param value
@@ -202,7 +756,7 @@ namespace Serialization
          * @tparam Type
          * @param values
          */
-        template<typename Type> void varint(const std::vector<Type> &values)
+        template<typename Type, typename Allocator> void varint(const std::vector<Type, Allocator> &values)
         {
             varint(values.size());
 
@@ -219,9 +773,89 @@ namespace Serialization
         [[nodiscard]] std::vector<unsigned char> vector() const;
 
       private:
+        template<typename Record, typename Allocator, typename Field>
+        void column(const std::vector<Record, Allocator> &records, Field Record::*field)
+        {
+            begin_nested();
+
+            if constexpr (std::is_same_v<Field, bool>)
+            {
+                std::vector<bool> values(records.size());
+
+                for (size_t i = 0; i < records.size(); ++i)
+                {
+                    values[i] = records[i].*field;
+                }
+
+                boolean(values);
+            }
+            else if constexpr (std::is_integral_v<Field>)
+            {
+                std::vector<std::make_unsigned_t<Field>> values(records.size());
+
+                for (size_t i = 0; i < records.size(); ++i)
+                {
+                    if constexpr (std::is_signed_v<Field>)
+                    {
+                        values[i] = zigzag_encode(records[i].*field);
+                    }
+                    else
+                    {
+                        values[i] = records[i].*field;
+                    }
+                }
+
+                bitpacked(values);
+            }
+            else if constexpr (std::is_trivially_copyable_v<Field>)
+            {
+                const auto position = buffer.size();
+
+                grow(records.size() * sizeof(Field));
+
+                buffer.resize(position + records.size() * sizeof(Field));
+
+                for (size_t i = 0; i < records.size(); ++i)
+                {
+                    std::memcpy(buffer.data() + position + i * sizeof(Field), &(records[i].*field), sizeof(Field));
+                }
+            }
+            else
+            {
+                for (const auto &record : records)
+                {
+                    pod(record.*field);
+                }
+            }
+
+            end_nested();
+        }
+
+        void expand(size_t additional);
+
         void extend(const std::vector<unsigned char> &vector);
 
-        std::vector<unsigned char> buffer;
+        void extend_fixed(const void *values, size_t count, size_t width, bool big_endian);
+
+        void grow(size_t additional)
+        {
+            if (buffer.capacity() - buffer.size() < additional)
+            {
+                expand(additional);
+            }
+        }
+
+        void sparse(const unsigned char *data, size_t length);
+
+        std::pmr::vector<unsigned char> buffer;
+
+        std::vector<std::tuple<size_t, bool, size_t>> nested;
+
+        std::vector<std::tuple<size_t, const unsigned char *, size_t>> gathered;
+
+        size_t gathered_bytes = 0, threshold = 0;
+
+        bool pooled = false;
     };
 
 } // namespace Serialization
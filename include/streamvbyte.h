@@ -0,0 +1,97 @@
+// Copyright (c) 2020-2024, Brandon Lehmann
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef SERIALIZATION_STREAMVBYTE_H
+#define SERIALIZATION_STREAMVBYTE_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Serialization
+{
+    /**
+     * Kernels that encode arrays of 32-bit values in the Stream VByte layout: the byte length of each
+     * value (1 to 4) is stored as a 2-bit code in a control stream, four codes per control byte, and the
+     * significant little-endian bytes of the values are stored separately in a data stream
+     *
+     * Note: As the position of every value in the data stream is known from the control bytes alone,
+     * the decoder expands four values at a time with a single byte shuffle looked up by control byte
+     */
+    namespace StreamVByte
+    {
+        /**
+         * Returns the number of control bytes required for the given number of values
+         *
+         * @param count
+         * @return
+         */
+        inline size_t control_size(size_t count)
+        {
+            return count / 4 + (count % 4 != 0 ? 1 : 0);
+        }
+
+        /**
+         * Returns the number of data bytes described by the control bytes of the given number of values
+         *
+         * @param control
+         * @param count
+         * @return
+         */
+        size_t data_size(const unsigned char *control, size_t count);
+
+        /**
+         * Decodes the given number of values from the control and data streams into the output; the
+         * length of the data stream must be at least data_size(control, count) bytes
+         *
+         * @param control
+         * @param data
+         * @param length
+         * @param count
+         * @param values
+         * @return the number of data bytes consumed
+         */
+        size_t decode(
+            const unsigned char *control,
+            const unsigned char *data,
+            size_t length,
+            size_t count,
+            uint32_t *values);
+
+        /**
+         * Encodes the given number of values into the control and data streams, which must have room for
+         * control_size(count) and count * 4 bytes respectively
+         *
+         * @param values
+         * @param count
+         * @param control
+         * @param data
+         * @return the number of data bytes written
+         */
+        size_t encode(const uint32_t *values, size_t count, unsigned char *control, unsigned char *data);
+    } // namespace StreamVByte
+} // namespace Serialization
+
+#endif
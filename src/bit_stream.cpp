@@ -0,0 +1,192 @@
+// Copyright (c) 2020-2024, Brandon Lehmann
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <bit_stream.h>
+
+namespace Serialization
+{
+    static inline uint64_t low_bits(uint64_t value, uint8_t count)
+    {
+        return count >= 64 ? value : value & ((uint64_t(1) << count) - 1);
+    }
+
+    bit_writer_t::bit_writer_t(serializer_t &writer): writer(writer) {}
+
+    bit_writer_t::~bit_writer_t()
+    {
+        flush();
+    }
+
+    void bit_writer_t::flags(const std::vector<bool> &values)
+    {
+        for (size_t i = 0; i < values.size(); i += 64)
+        {
+            const auto count = std::min<size_t>(64, values.size() - i);
+
+            uint64_t word = 0;
+
+            for (size_t j = 0; j < count; ++j)
+            {
+                word |= uint64_t(values[i + j]) << j;
+            }
+
+            bits(word, uint8_t(count));
+        }
+    }
+
+    void bit_writer_t::flush()
+    {
+        for (uint8_t i = 0; i < used; i += 8)
+        {
+            writer.uint8(uint8_t(accumulator >> i));
+        }
+
+        accumulator = 0;
+
+        used = 0;
+    }
+
+    void bit_writer_t::spill(uint64_t value, uint8_t count)
+    {
+        if (count > 64)
+        {
+            throw std::invalid_argument("bit count must not exceed 64");
+        }
+
+        value = low_bits(value, count);
+
+        accumulator |= value << used;
+
+        if (used + count < 64)
+        {
+            used += count;
+
+            return;
+        }
+
+        // the accumulator is full, append it and keep the bits of the value that did not fit
+        writer.uint64(&accumulator, 1);
+
+        accumulator = (used == 0) ? 0 : value >> (64 - used);
+
+        used = uint8_t(used + count - 64);
+    }
+
+    bit_reader_t::bit_reader_t(deserializer_t &reader): reader(reader) {}
+
+    bit_reader_t::~bit_reader_t()
+    {
+        align();
+    }
+
+    void bit_reader_t::align()
+    {
+        // whole bytes were loaded ahead of time, give them back
+        reader.reset(reader.size() - reader.unread_bytes() - available / 8);
+
+        accumulator = 0;
+
+        available = 0;
+    }
+
+    uint64_t bit_reader_t::fill(uint8_t count)
+    {
+        if (count > 64)
+        {
+            throw std::invalid_argument("bit count must not exceed 64");
+        }
+
+        if (count <= available)
+        {
+            const auto result = low_bits(accumulator, count);
+
+            accumulator = (count == 64) ? 0 : accumulator >> count;
+
+            available -= count;
+
+            return result;
+        }
+
+        // take the bits that remain, then the rest of the value from the following bytes
+        const auto result = accumulator, taken = uint64_t(available);
+
+        refill();
+
+        const auto remaining = uint8_t(count - taken);
+
+        if (remaining > available)
+        {
+            // the reader has been exhausted, let it raise the usual out of data error
+            reader.bytes(1, true);
+        }
+
+        const auto rest = low_bits(accumulator, remaining);
+
+        accumulator = (remaining == 64) ? 0 : accumulator >> remaining;
+
+        available -= remaining;
+
+        return result | (rest << taken);
+    }
+
+    std::vector<bool> bit_reader_t::flags(size_t count)
+    {
+        std::vector<bool> result(count);
+
+        for (size_t i = 0; i < count; i += 64)
+        {
+            const auto length = std::min<size_t>(64, count - i);
+
+            const auto word = bits(uint8_t(length));
+
+            for (size_t j = 0; j < length; ++j)
+            {
+                result[i + j] = ((word >> j) & 1) != 0;
+            }
+        }
+
+        return result;
+    }
+
+    void bit_reader_t::refill()
+    {
+        const auto length = std::min<size_t>(sizeof(uint64_t), reader.unread_bytes());
+
+        unsigned char bytes[sizeof(uint64_t)] = {0};
+
+        // an empty read raises the usual out of data error at the current position
+        reader.bytes(bytes, length == 0 ? 1 : length);
+
+        accumulator = 0;
+
+        for (size_t i = 0; i < length; ++i)
+        {
+            accumulator |= uint64_t(bytes[i]) << (i * 8);
+        }
+
+        available = uint8_t(length * 8);
+    }
+} // namespace Serialization
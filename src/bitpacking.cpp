@@ -0,0 +1,277 @@
+// Copyright (c) 2020-2024, Brandon Lehmann
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <bitpacking.h>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BITPACKING_SSE2
+#endif
+
+namespace Serialization::BitPacking
+{
+#ifdef BITPACKING_SSE2
+    typedef __m128i lane_t;
+
+    static inline lane_t load(const void *input)
+    {
+        return _mm_loadu_si128(static_cast<const __m128i *>(input));
+    }
+
+    static inline void store(void *output, const lane_t &value)
+    {
+        _mm_storeu_si128(static_cast<__m128i *>(output), value);
+    }
+
+    static inline lane_t zero()
+    {
+        return _mm_setzero_si128();
+    }
+
+    static inline lane_t mask(uint32_t bits)
+    {
+        return _mm_set1_epi32(static_cast<int>(bits));
+    }
+
+    static inline lane_t bit_and(const lane_t &a, const lane_t &b)
+    {
+        return _mm_and_si128(a, b);
+    }
+
+    static inline lane_t bit_or(const lane_t &a, const lane_t &b)
+    {
+        return _mm_or_si128(a, b);
+    }
+
+    static inline lane_t shift_left(const lane_t &value, uint32_t count)
+    {
+        return _mm_slli_epi32(value, static_cast<int>(count));
+    }
+
+    static inline lane_t shift_right(const lane_t &value, uint32_t count)
+    {
+        return _mm_srli_epi32(value, static_cast<int>(count));
+    }
+#else
+    // portable four lane fallback, laid out identically in memory to the vector registers
+    struct lane_t
+    {
+        uint32_t words[4];
+    };
+
+    static inline lane_t load(const void *input)
+    {
+        lane_t result;
+
+        std::memcpy(result.words, input, sizeof(result.words));
+
+        return result;
+    }
+
+    static inline void store(void *output, const lane_t &value)
+    {
+        std::memcpy(output, value.words, sizeof(value.words));
+    }
+
+    static inline lane_t zero()
+    {
+        return {{0, 0, 0, 0}};
+    }
+
+    static inline lane_t mask(uint32_t bits)
+    {
+        return {{bits, bits, bits, bits}};
+    }
+
+    static inline lane_t bit_and(const lane_t &a, const lane_t &b)
+    {
+        return {{a.words[0] & b.words[0], a.words[1] & b.words[1], a.words[2] & b.words[2], a.words[3] & b.words[3]}};
+    }
+
+    static inline lane_t bit_or(const lane_t &a, const lane_t &b)
+    {
+        return {{a.words[0] | b.words[0], a.words[1] | b.words[1], a.words[2] | b.words[2], a.words[3] | b.words[3]}};
+    }
+
+    static inline lane_t shift_left(const lane_t &value, uint32_t count)
+    {
+        return {{value.words[0] << count, value.words[1] << count, value.words[2] << count, value.words[3] << count}};
+    }
+
+    static inline lane_t shift_right(const lane_t &value, uint32_t count)
+    {
+        return {{value.words[0] >> count, value.words[1] >> count, value.words[2] >> count, value.words[3] >> count}};
+    }
+#endif
+
+    static inline lane_t value_mask(uint32_t width)
+    {
+        return mask(width == 32 ? 0xffffffff : (uint32_t(1) << width) - 1);
+    }
+
+    /**
+     * Packs one row of four lanes into the output words; every position and shift is a compile time
+     * constant so the rows of a block unroll into straight-line vector code
+     */
+    template<uint32_t Width, size_t Row>
+    static inline void pack_row(const uint32_t *values, lane_t *words, const lane_t &value_mask)
+    {
+        constexpr size_t bit = Row * Width, word = bit / 32;
+
+        constexpr uint32_t shift = bit % 32;
+
+        const auto value = bit_and(load(values + Row * 4), value_mask);
+
+        words[word] = bit_or(words[word], shift_left(value, shift));
+
+        // carry the bits of the value that did not fit into the next word
+        if constexpr (shift + Width > 32)
+        {
+            words[word + 1] = bit_or(words[word + 1], shift_right(value, 32 - shift));
+        }
+    }
+
+    template<uint32_t Width, size_t... Rows>
+    static void pack_rows(const uint32_t *values, unsigned char *output, std::index_sequence<Rows...>)
+    {
+        const auto mask = value_mask(Width);
+
+        lane_t words[Width];
+
+        for (auto &word : words)
+        {
+            word = zero();
+        }
+
+        (pack_row<Width, Rows>(values, words, mask), ...);
+
+        for (size_t i = 0; i < Width; ++i)
+        {
+            store(output + i * 16, words[i]);
+        }
+    }
+
+    template<uint32_t Width> static void pack_width(const uint32_t *values, unsigned char *output)
+    {
+        pack_rows<Width>(values, output, std::make_index_sequence<BITPACKING_BLOCK_SIZE / 4>());
+    }
+
+    /**
+     * Unpacks one row of four lanes from the input words; every position and shift is a compile time
+     * constant so the rows of a block unroll into straight-line vector code
+     */
+    template<uint32_t Width, size_t Row>
+    static inline void unpack_row(const unsigned char *input, uint32_t *values, const lane_t &value_mask)
+    {
+        constexpr size_t bit = Row * Width, word = bit / 32;
+
+        constexpr uint32_t shift = bit % 32;
+
+        auto value = shift_right(load(input + word * 16), shift);
+
+        // pull in the bits of the value that spilled into the next word
+        if constexpr (shift + Width > 32)
+        {
+            value = bit_or(value, shift_left(load(input + (word + 1) * 16), 32 - shift));
+        }
+
+        store(values + Row * 4, bit_and(value, value_mask));
+    }
+
+    template<uint32_t Width, size_t... Rows>
+    static void unpack_rows(const unsigned char *input, uint32_t *values, std::index_sequence<Rows...>)
+    {
+        const auto mask = value_mask(Width);
+
+        (unpack_row<Width, Rows>(input, values, mask), ...);
+    }
+
+    template<uint32_t Width> static void unpack_width(const unsigned char *input, uint32_t *values)
+    {
+        unpack_rows<Width>(input, values, std::make_index_sequence<BITPACKING_BLOCK_SIZE / 4>());
+    }
+
+    template<uint32_t... Widths> struct dispatch_t
+    {
+        static void pack(const uint32_t *values, uint8_t width, unsigned char *output)
+        {
+            using kernel_t = void (*)(const uint32_t *, unsigned char *);
+
+            static const kernel_t kernels[] = {pack_width<Widths>...};
+
+            kernels[width - 1](values, output);
+        }
+
+        static void unpack(const unsigned char *input, uint8_t width, uint32_t *values)
+        {
+            using kernel_t = void (*)(const unsigned char *, uint32_t *);
+
+            static const kernel_t kernels[] = {unpack_width<Widths>...};
+
+            kernels[width - 1](input, values);
+        }
+    };
+
+    typedef dispatch_t<
+        1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14, 15, 16,
+        17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32>
+        kernels_t;
+
+    void pack(const uint32_t *values, uint8_t width, unsigned char *output)
+    {
+        if (width > 32)
+        {
+            throw std::invalid_argument("bit width must not exceed 32");
+        }
+
+        if (width == 0)
+        {
+            return;
+        }
+
+        kernels_t::pack(values, width, output);
+    }
+
+    void unpack(const unsigned char *input, uint8_t width, uint32_t *values)
+    {
+        if (width > 32)
+        {
+            throw std::invalid_argument("bit width must not exceed 32");
+        }
+
+        if (width == 0)
+        {
+            std::memset(values, 0, BITPACKING_BLOCK_SIZE * sizeof(uint32_t));
+
+            return;
+        }
+
+        kernels_t::unpack(input, width, values);
+    }
+} // namespace Serialization::BitPacking
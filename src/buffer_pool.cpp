@@ -0,0 +1,205 @@
+// Copyright (c) 2020-2024, Brandon Lehmann
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <atomic>
+#include <buffer_pool.h>
+
+// smallest and largest buffer capacities (as powers of two) that the pool retains
+#define BUFFER_POOL_MIN_BUCKET 8
+#define BUFFER_POOL_MAX_BUCKET 24
+#define BUFFER_POOL_BUCKET_DEPTH 8
+
+namespace Serialization::BufferPool
+{
+    static std::atomic<bool> pool_enabled(false);
+
+    // set once the pool of the thread has been destroyed (ie. serializer_t with static storage duration)
+    static thread_local bool pool_destroyed = false;
+
+    struct thread_pool_t
+    {
+        ~thread_pool_t()
+        {
+            pool_destroyed = true;
+        }
+
+        std::vector<std::pmr::vector<unsigned char>> buckets[BUFFER_POOL_MAX_BUCKET + 1];
+
+        buffer_pool_stats_t stats;
+    };
+
+    static thread_pool_t &local_pool()
+    {
+        static thread_local thread_pool_t pool;
+
+        return pool;
+    }
+
+    /**
+     * Returns the smallest bucket whose buffers are all guaranteed to hold the given capacity
+     */
+    static size_t bucket_for_request(size_t capacity)
+    {
+        size_t bucket = BUFFER_POOL_MIN_BUCKET;
+
+        while (bucket <= BUFFER_POOL_MAX_BUCKET && (size_t(1) << bucket) < capacity)
+        {
+            bucket++;
+        }
+
+        return bucket;
+    }
+
+    std::pmr::vector<unsigned char> acquire(size_t capacity)
+    {
+        if (pool_destroyed)
+        {
+            return {};
+        }
+
+        auto &pool = local_pool();
+
+        for (auto bucket = bucket_for_request(capacity); bucket <= BUFFER_POOL_MAX_BUCKET; ++bucket)
+        {
+            auto &buffers = pool.buckets[bucket];
+
+            if (!buffers.empty())
+            {
+                auto buffer = std::move(buffers.back());
+
+                buffers.pop_back();
+
+                pool.stats.hits++;
+
+                pool.stats.retained_buffers--;
+
+                pool.stats.retained_bytes -= buffer.capacity();
+
+                return buffer;
+            }
+        }
+
+        pool.stats.misses++;
+
+        std::pmr::vector<unsigned char> buffer;
+
+        buffer.reserve(std::max(capacity, size_t(1) << BUFFER_POOL_MIN_BUCKET));
+
+        return buffer;
+    }
+
+    void clear()
+    {
+        if (pool_destroyed)
+        {
+            return;
+        }
+
+        auto &pool = local_pool();
+
+        for (auto &buffers : pool.buckets)
+        {
+            buffers.clear();
+        }
+
+        pool.stats.retained_buffers = 0;
+
+        pool.stats.retained_bytes = 0;
+    }
+
+    void enable(bool value)
+    {
+        pool_enabled.store(value, std::memory_order_relaxed);
+    }
+
+    bool enabled()
+    {
+        return pool_enabled.load(std::memory_order_relaxed);
+    }
+
+    void release(std::pmr::vector<unsigned char> &&buffer)
+    {
+        if (pool_destroyed)
+        {
+            return;
+        }
+
+        auto &pool = local_pool();
+
+        const auto capacity = buffer.capacity();
+
+        // buffers are filed under the largest power of two that they can hold
+        size_t bucket = 0;
+
+        while (bucket < 63 && (size_t(1) << (bucket + 1)) <= capacity)
+        {
+            bucket++;
+        }
+
+        // buffers allocated from other memory resources (ie. arenas) may not outlive them
+        if (bucket < BUFFER_POOL_MIN_BUCKET || bucket > BUFFER_POOL_MAX_BUCKET
+            || pool.buckets[bucket].size() >= BUFFER_POOL_BUCKET_DEPTH
+            || buffer.get_allocator().resource() != std::pmr::get_default_resource())
+        {
+            pool.stats.discarded++;
+
+            return;
+        }
+
+        buffer.clear();
+
+        pool.buckets[bucket].push_back(std::move(buffer));
+
+        pool.stats.released++;
+
+        pool.stats.retained_buffers++;
+
+        pool.stats.retained_bytes += capacity;
+    }
+
+    void reset_stats()
+    {
+        if (pool_destroyed)
+        {
+            return;
+        }
+
+        auto &stats = local_pool().stats;
+
+        stats.hits = stats.misses = stats.released = stats.discarded = 0;
+    }
+
+    buffer_pool_stats_t stats()
+    {
+        if (pool_destroyed)
+        {
+            return {};
+        }
+
+        return local_pool().stats;
+    }
+} // namespace Serialization::BufferPool
@@ -0,0 +1,167 @@
+// Copyright (c) 2020-2024, Brandon Lehmann
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <byte_order.h>
+#include <cstring>
+#include <serialization_helper.h>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BYTE_ORDER_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define BYTE_ORDER_NEON
+#endif
+
+namespace Serialization::ByteOrder
+{
+#if defined(BYTE_ORDER_SSE2)
+    /**
+     * Reverses the bytes of each value in sixteen byte blocks using only SSE2: the bytes within each
+     * 16-bit word are exchanged with shifts, then the words within each value are reordered
+     */
+    template<size_t Width> static size_t swap_blocks(const unsigned char *input, unsigned char *output, size_t length)
+    {
+        size_t i = 0;
+
+        for (; i + 16 <= length; i += 16)
+        {
+            auto value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i));
+
+            value = _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8));
+
+            if constexpr (Width == 4)
+            {
+                value = _mm_shufflelo_epi16(value, _MM_SHUFFLE(2, 3, 0, 1));
+
+                value = _mm_shufflehi_epi16(value, _MM_SHUFFLE(2, 3, 0, 1));
+            }
+            else if constexpr (Width == 8)
+            {
+                value = _mm_shufflelo_epi16(value, _MM_SHUFFLE(0, 1, 2, 3));
+
+                value = _mm_shufflehi_epi16(value, _MM_SHUFFLE(0, 1, 2, 3));
+            }
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i), value);
+        }
+
+        return i;
+    }
+#elif defined(BYTE_ORDER_NEON)
+    template<size_t Width> static size_t swap_blocks(const unsigned char *input, unsigned char *output, size_t length)
+    {
+        size_t i = 0;
+
+        for (; i + 16 <= length; i += 16)
+        {
+            const auto value = vld1q_u8(input + i);
+
+            if constexpr (Width == 2)
+            {
+                vst1q_u8(output + i, vrev16q_u8(value));
+            }
+            else if constexpr (Width == 4)
+            {
+                vst1q_u8(output + i, vrev32q_u8(value));
+            }
+            else
+            {
+                vst1q_u8(output + i, vrev64q_u8(value));
+            }
+        }
+
+        return i;
+    }
+#else
+    template<size_t Width> static size_t swap_blocks(const unsigned char *, unsigned char *, size_t)
+    {
+        return 0;
+    }
+#endif
+
+    template<size_t Width> static void swap_width(const unsigned char *input, unsigned char *output, size_t count)
+    {
+        const auto length = count * Width;
+
+        // the blocks always end on a value boundary as sixteen is a multiple of every width
+        for (auto i = swap_blocks<Width>(input, output, length); i < length; i += Width)
+        {
+            for (size_t j = 0; j < Width; ++j)
+            {
+                output[i + j] = input[i + Width - 1 - j];
+            }
+        }
+    }
+
+    void copy(const void *input, void *output, size_t count, size_t width, bool big_endian)
+    {
+#ifdef SERIALIZATION_BIG_ENDIAN_HOST
+        const auto swapped = !big_endian;
+#else
+        const auto swapped = big_endian;
+#endif
+
+        if (count == 0)
+        {
+            return;
+        }
+
+        if (swapped)
+        {
+            swap(input, output, count, width);
+        }
+        else
+        {
+            std::memcpy(output, input, count * width);
+        }
+    }
+
+    void swap(const void *input, void *output, size_t count, size_t width)
+    {
+        const auto in = static_cast<const unsigned char *>(input);
+
+        const auto out = static_cast<unsigned char *>(output);
+
+        if (width == 2)
+        {
+            swap_width<2>(in, out, count);
+        }
+        else if (width == 4)
+        {
+            swap_width<4>(in, out, count);
+        }
+        else if (width == 8)
+        {
+            swap_width<8>(in, out, count);
+        }
+        else
+        {
+            throw std::invalid_argument("width must be 2, 4 or 8 bytes");
+        }
+    }
+} // namespace Serialization::ByteOrder
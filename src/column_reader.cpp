@@ -0,0 +1,81 @@
+// Copyright (c) 2020-2024, Brandon Lehmann
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <column_reader.h>
+
+namespace Serialization
+{
+    column_reader_t::column_reader_t(deserializer_t &reader)
+    {
+        const auto start = reader.size() - reader.unread_bytes();
+
+        try
+        {
+            count = reader.varint<uint64_t>();
+
+            const auto columns = reader.varint<uint64_t>();
+
+            // every column occupies at least its length prefix, so refuse counts that cannot possibly be satisfied
+            if (columns > reader.unread_bytes())
+            {
+                throw std::range_error("not enough data to complete request at position " + std::to_string(start));
+            }
+
+            slices.reserve(columns);
+
+            for (size_t i = 0; i < columns; ++i)
+            {
+                slices.push_back(reader.slice(reader.varint<uint64_t>()));
+            }
+        }
+        catch (...)
+        {
+            reader.reset(start);
+
+            throw;
+        }
+    }
+
+    size_t column_reader_t::columns() const
+    {
+        return slices.size();
+    }
+
+    size_t column_reader_t::size() const
+    {
+        return count;
+    }
+
+    deserializer_t column_reader_t::slice(size_t index) const
+    {
+        if (index >= slices.size())
+        {
+            throw std::out_of_range("column index out of range");
+        }
+
+        return slices[index];
+    }
+} // namespace Serialization
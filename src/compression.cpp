@@ -0,0 +1,474 @@
+// Copyright (c) 2020-2024, Brandon Lehmann
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <compression.h>
+#include <cstring>
+#include <rope_deserializer_t.h>
+#include <stdexcept>
+
+namespace Serialization
+{
+    namespace Compression
+    {
+        // the shortest match worth encoding
+        static constexpr size_t MIN_MATCH = 4;
+
+        // the final bytes of a block are always literals, and no match may start within the last MATCH_LIMIT bytes
+        static constexpr size_t LAST_LITERALS = 5, MATCH_LIMIT = 12;
+
+        static constexpr size_t MAX_OFFSET = 65535;
+
+        static constexpr uint32_t HASH_BITS = 14;
+
+        static inline uint32_t read32(const unsigned char *input)
+        {
+            uint32_t value;
+
+            std::memcpy(&value, input, sizeof(value));
+
+            return value;
+        }
+
+        static inline uint64_t read64(const unsigned char *input)
+        {
+            uint64_t value;
+
+            std::memcpy(&value, input, sizeof(value));
+
+            return value;
+        }
+
+        static inline uint32_t hash(uint32_t value)
+        {
+            return (value * 2654435761U) >> (32 - HASH_BITS);
+        }
+
+        /**
+         * Writes the remainder of a length that did not fit in its token nibble
+         */
+        static inline void write_length(unsigned char *&output, size_t length)
+        {
+            while (length >= 255)
+            {
+                *output++ = 255;
+
+                length -= 255;
+            }
+
+            *output++ = static_cast<unsigned char>(length);
+        }
+
+        /**
+         * Reads the remainder of a length that did not fit in its token nibble
+         */
+        static inline size_t read_length(const unsigned char *&input, const unsigned char *end)
+        {
+            size_t length = 0;
+
+            while (true)
+            {
+                if (input == end || length > SIZE_MAX / 2)
+                {
+                    throw std::range_error("malformed compressed data");
+                }
+
+                const auto value = *input++;
+
+                length += value;
+
+                if (value != 255)
+                {
+                    return length;
+                }
+            }
+        }
+
+        static inline void write_sequence(
+            unsigned char *&output,
+            const unsigned char *literals,
+            size_t literal_length,
+            size_t offset,
+            size_t match_length)
+        {
+            auto token = output++;
+
+            *token = static_cast<unsigned char>(std::min<size_t>(literal_length, 15) << 4);
+
+            if (literal_length >= 15)
+            {
+                write_length(output, literal_length - 15);
+            }
+
+            if (literal_length != 0)
+            {
+                std::memcpy(output, literals, literal_length);
+
+                output += literal_length;
+            }
+
+            if (match_length == 0)
+            {
+                return;
+            }
+
+            match_length -= MIN_MATCH;
+
+            *token |= static_cast<unsigned char>(std::min<size_t>(match_length, 15));
+
+            *output++ = static_cast<unsigned char>(offset);
+
+            *output++ = static_cast<unsigned char>(offset >> 8);
+
+            if (match_length >= 15)
+            {
+                write_length(output, match_length - 15);
+            }
+        }
+
+        size_t compress(const void *input, size_t length, void *output)
+        {
+            const auto in = static_cast<const unsigned char *>(input);
+
+            const auto out = static_cast<unsigned char *>(output);
+
+            auto op = out;
+
+            auto anchor = in;
+
+            if (length > MATCH_LIMIT)
+            {
+                std::vector<uint32_t> table(size_t(1) << HASH_BITS, 0);
+
+                const auto match_limit = in + length - MATCH_LIMIT, match_end = in + length - LAST_LITERALS;
+
+                auto ip = in + 1;
+
+                while (ip < match_limit)
+                {
+                    // search for a match, skipping ahead faster the longer we go without finding one
+                    const unsigned char *match = nullptr;
+
+                    size_t attempts = size_t(1) << 6;
+
+                    while (ip < match_limit)
+                    {
+                        const auto value = read32(ip);
+
+                        const auto slot = hash(value);
+
+                        const auto candidate = in + table[slot];
+
+                        table[slot] = static_cast<uint32_t>(ip - in);
+
+                        if (candidate < ip && size_t(ip - candidate) <= MAX_OFFSET && read32(candidate) == value)
+                        {
+                            match = candidate;
+
+                            break;
+                        }
+
+                        ip += attempts++ >> 6;
+                    }
+
+                    if (match == nullptr)
+                    {
+                        break;
+                    }
+
+                    // extend the match backwards over any literals that also match
+                    while (ip > anchor && match > in && ip[-1] == match[-1])
+                    {
+                        ip--;
+
+                        match--;
+                    }
+
+                    // then forwards, a word at a time where possible
+                    auto end = ip + MIN_MATCH, reference = match + MIN_MATCH;
+
+                    while (end + sizeof(uint64_t) <= match_end && read64(end) == read64(reference))
+                    {
+                        end += sizeof(uint64_t);
+
+                        reference += sizeof(uint64_t);
+                    }
+
+                    while (end < match_end && *end == *reference)
+                    {
+                        end++;
+
+                        reference++;
+                    }
+
+                    write_sequence(op, anchor, size_t(ip - anchor), size_t(ip - match), size_t(end - ip));
+
+                    ip = end;
+
+                    anchor = ip;
+
+                    if (ip < match_limit)
+                    {
+                        table[hash(read32(ip - 2))] = static_cast<uint32_t>(ip - 2 - in);
+                    }
+                }
+            }
+
+            write_sequence(op, anchor, size_t(in + length - anchor), 0, 0);
+
+            return size_t(op - out);
+        }
+
+        size_t decompress(const void *input, size_t length, void *output, size_t capacity)
+        {
+            auto ip = static_cast<const unsigned char *>(input);
+
+            const auto ie = ip + length;
+
+            const auto out = static_cast<unsigned char *>(output);
+
+            const auto oe = out + capacity;
+
+            auto op = out;
+
+            while (true)
+            {
+                if (ip == ie)
+                {
+                    throw std::range_error("malformed compressed data");
+                }
+
+                const auto token = *ip++;
+
+                auto literal_length = size_t(token >> 4);
+
+                if (literal_length == 15)
+                {
+                    literal_length += read_length(ip, ie);
+                }
+
+                if (literal_length > size_t(ie - ip) || literal_length > size_t(oe - op))
+                {
+                    throw std::range_error("malformed compressed data");
+                }
+
+                std::memcpy(op, ip, literal_length);
+
+                ip += literal_length;
+
+                op += literal_length;
+
+                // the final sequence holds only literals
+                if (ip == ie)
+                {
+                    return size_t(op - out);
+                }
+
+                if (ie - ip < 2)
+                {
+                    throw std::range_error("malformed compressed data");
+                }
+
+                const auto offset = size_t(ip[0]) | (size_t(ip[1]) << 8);
+
+                ip += 2;
+
+                auto match_length = size_t(token & 15);
+
+                if (match_length == 15)
+                {
+                    match_length += read_length(ip, ie);
+                }
+
+                match_length += MIN_MATCH;
+
+                if (offset == 0 || offset > size_t(op - out) || match_length > size_t(oe - op))
+                {
+                    throw std::range_error("malformed compressed data");
+                }
+
+                const auto reference = op - offset;
+
+                if (offset == 1)
+                {
+                    std::memset(op, *reference, match_length);
+                }
+                else if (offset >= sizeof(uint64_t))
+                {
+                    // the source never overlaps the destination within a single word
+                    size_t i = 0;
+
+                    for (; i + sizeof(uint64_t) <= match_length; i += sizeof(uint64_t))
+                    {
+                        std::memcpy(op + i, reference + i, sizeof(uint64_t));
+                    }
+
+                    for (; i < match_length; ++i)
+                    {
+                        op[i] = reference[i];
+                    }
+                }
+                else
+                {
+                    for (size_t i = 0; i < match_length; ++i)
+                    {
+                        op[i] = reference[i];
+                    }
+                }
+
+                op += match_length;
+            }
+        }
+    } // namespace Compression
+
+    static inline uint32_t read_le32(const unsigned char *input)
+    {
+        return uint32_t(input[0]) | (uint32_t(input[1]) << 8) | (uint32_t(input[2]) << 16)
+               | (uint32_t(input[3]) << 24);
+    }
+
+    // each chunk is prefixed by its uncompressed and stored lengths
+    static constexpr size_t CHUNK_HEADER_SIZE = 2 * sizeof(uint32_t);
+
+    decompressor_t::decompressor_t(rope_deserializer_t &reader, size_t max_chunk_size):
+        reader(reader), max_chunk_size(max_chunk_size)
+    {
+    }
+
+    void decompressor_t::chunk(const unsigned char *data)
+    {
+        const auto length = read_le32(data), stored = read_le32(data + sizeof(uint32_t));
+
+        if (length == 0)
+        {
+            done = true;
+
+            return;
+        }
+
+        std::vector<unsigned char> result(length);
+
+        if (stored == length)
+        {
+            std::memcpy(result.data(), data + CHUNK_HEADER_SIZE, length);
+        }
+        else if (Compression::decompress(data + CHUNK_HEADER_SIZE, stored, result.data(), length) != length)
+        {
+            throw std::range_error("compressed chunk length mismatch");
+        }
+
+        reader.append(std::move(result));
+    }
+
+    bool decompressor_t::finished() const
+    {
+        return done;
+    }
+
+    uint32_t decompressor_t::header(const unsigned char *data) const
+    {
+        const auto length = read_le32(data), stored = read_le32(data + sizeof(uint32_t));
+
+        if (length == 0)
+        {
+            if (stored != 0)
+            {
+                throw std::range_error("malformed compressed chunk header");
+            }
+
+            return 0;
+        }
+
+        // refuse lengths that the stored bytes cannot possibly expand to before buffering or allocating
+        if (stored > length || length > max_chunk_size || length > size_t(stored) * 255 + 16)
+        {
+            throw std::range_error("malformed compressed chunk header");
+        }
+
+        return stored;
+    }
+
+    size_t decompressor_t::write(const void *data, size_t length)
+    {
+        auto input = static_cast<const unsigned char *>(data);
+
+        const auto start = input, end = input + length;
+
+        while (input != end && !done)
+        {
+            const auto available = size_t(end - input);
+
+            // decompress whole chunks straight from the input when nothing is pending
+            if (pending.empty() && available >= CHUNK_HEADER_SIZE)
+            {
+                const auto stored = header(input);
+
+                if (available - CHUNK_HEADER_SIZE >= stored)
+                {
+                    chunk(input);
+
+                    input += CHUNK_HEADER_SIZE + stored;
+
+                    continue;
+                }
+            }
+
+            // otherwise collect the header, then the rest of the chunk, across calls, validating the header
+            // as soon as it is complete so that a hostile length is never buffered
+            auto needed = CHUNK_HEADER_SIZE;
+
+            if (pending.size() >= CHUNK_HEADER_SIZE)
+            {
+                needed += header(pending.data());
+            }
+
+            const auto count = std::min(needed - pending.size(), available);
+
+            pending.insert(pending.end(), input, input + count);
+
+            input += count;
+
+            if (pending.size() < CHUNK_HEADER_SIZE)
+            {
+                continue;
+            }
+
+            if (pending.size() == CHUNK_HEADER_SIZE + header(pending.data()))
+            {
+                chunk(pending.data());
+
+                pending.clear();
+            }
+        }
+
+        return size_t(input - start);
+    }
+
+    size_t decompressor_t::write(const std::vector<unsigned char> &data)
+    {
+        return write(data.data(), data.size());
+    }
+} // namespace Serialization
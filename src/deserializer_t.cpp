@@ -24,28 +24,91 @@
 // STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
 // THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <bit_stream.h>
+#include <byte_order.h>
 #include <deserializer_t.h>
 
 namespace Serialization
 {
-    deserializer_t::deserializer_t(const serializer_t &writer)
+    deserializer_t::deserializer_t(const serializer_t &writer, std::pmr::memory_resource *resource):
+        resource(resource)
     {
-        buffer = writer.vector();
+        auto storage = create(resource);
+
+        storage->reserve(writer.size());
+
+        for (const auto &segment : writer.segments())
+        {
+            storage->insert(storage->end(), segment.data, segment.data + segment.length);
+        }
+
+        adopt(std::move(storage));
     }
 
     deserializer_t::deserializer_t(std::initializer_list<unsigned char> input)
     {
-        buffer = std::vector<unsigned char>(input.begin(), input.end());
+        adopt(create(resource, input.begin(), input.end()));
+    }
+
+    deserializer_t::deserializer_t(const std::vector<unsigned char> &input, std::pmr::memory_resource *resource):
+        resource(resource)
+    {
+        adopt(create(resource, input.begin(), input.end()));
+    }
+
+    deserializer_t::deserializer_t(std::vector<unsigned char> &&input)
+    {
+        // the moved vector is kept as is, rather than copied into a reusable storage vector
+        const auto moved = std::make_shared<const std::vector<unsigned char>>(std::move(input));
+
+        buffer = moved;
+
+        memory = moved->data();
+
+        length = moved->size();
+    }
+
+    deserializer_t::deserializer_t(const std::string &input): deserializer_t(from_hex(input)) {}
+
+    void deserializer_t::adopt(std::shared_ptr<std::pmr::vector<unsigned char>> value)
+    {
+        storage = value.get();
+
+        memory = value->data();
+
+        buffer = std::move(value);
+
+        base = 0;
+
+        length = storage->size();
+
+        offset = 0;
     }
 
-    deserializer_t::deserializer_t(const std::vector<unsigned char> &input)
+    void deserializer_t::assign(const unsigned char *data, size_t length)
     {
-        buffer = input;
+        // no other reader holds the storage vector, so its capacity may be reused
+        if (storage != nullptr && buffer.use_count() == 1)
+        {
+            storage->assign(data, data + length);
+
+            memory = storage->data();
+
+            base = 0;
+
+            this->length = length;
+
+            offset = 0;
+
+            return;
+        }
+
+        adopt(create(resource, data, data + length));
     }
 
-    deserializer_t::deserializer_t(const std::string &input)
+    void deserializer_t::assign(const std::vector<unsigned char> &data)
     {
-        buffer = from_hex(input);
+        assign(data.data(), data.size());
     }
 
     bool deserializer_t::boolean(bool peek)
@@ -53,26 +116,84 @@ namespace Serialization
         return uint8(peek) == 1;
     }
 
-    std::vector<unsigned char> deserializer_t::bytes(size_t count, bool peek)
+    std::vector<bool> deserializer_t::booleanV(bool peek)
     {
         const auto start = offset;
 
+        const auto count = varint<uint64_t>();
+
+        // every eight elements occupy a byte, so refuse counts that cannot possibly be satisfied
+        require(count / 8 + (count % 8 != 0 ? 1 : 0));
+
+        std::vector<bool> result;
+
+        {
+            bit_reader_t reader(*this);
+
+            result = reader.flags(count);
+        }
+
+        if (peek)
+        {
+            reset(start);
+        }
+
+        return result;
+    }
+
+    std::vector<unsigned char> deserializer_t::bytes(size_t count, bool peek)
+    {
+        require(count);
+
+        const auto start = data() + offset;
+
         if (!peek)
         {
             offset += count;
         }
 
-        return {buffer.begin() + start, buffer.begin() + start + count};
+        return {start, start + count};
+    }
+
+    void deserializer_t::bytes(void *output, size_t count, bool peek)
+    {
+        require(count);
+
+        std::memcpy(output, data() + offset, count);
+
+        if (!peek)
+        {
+            offset += count;
+        }
     }
 
     void deserializer_t::compact()
     {
-        buffer = std::vector<unsigned char>(buffer.begin() + offset, buffer.end());
+        // the buffer may be shared with other readers so a new one is always created
+        adopt(create(resource, data() + std::min(offset, length), data() + length));
     }
 
     const unsigned char *deserializer_t::data() const
     {
-        return buffer.data();
+        return memory + base;
+    }
+
+    void deserializer_t::fixed(void *output, size_t count, size_t width, bool peek, bool big_endian)
+    {
+        if (count > SIZE_MAX / width)
+        {
+            throw std::range_error(
+                "not enough data to complete request at position " + std::to_string(base + offset));
+        }
+
+        require(count * width);
+
+        ByteOrder::copy(data() + offset, output, count, width, big_endian);
+
+        if (!peek)
+        {
+            offset += count * width;
+        }
     }
 
     std::string deserializer_t::hex(size_t length, bool peek)
@@ -82,6 +203,15 @@ namespace Serialization
         return to_hex(temp.data(), temp.size());
     }
 
+    void deserializer_t::require(size_t count) const
+    {
+        if (offset > length || count > length - offset)
+        {
+            throw std::range_error(
+                "not enough data to complete request at position " + std::to_string(base + offset));
+        }
+    }
+
     void deserializer_t::reset(size_t position)
     {
         offset = position;
@@ -89,7 +219,27 @@ namespace Serialization
 
     size_t deserializer_t::size() const
     {
-        return buffer.size();
+        return length;
+    }
+
+    deserializer_t deserializer_t::slice(size_t count, bool peek)
+    {
+        require(count);
+
+        auto reader = *this;
+
+        reader.base = base + offset;
+
+        reader.length = count;
+
+        reader.offset = 0;
+
+        if (!peek)
+        {
+            offset += count;
+        }
+
+        return reader;
     }
 
     void deserializer_t::skip(size_t count)
@@ -97,13 +247,93 @@ namespace Serialization
         offset += count;
     }
 
+    void deserializer_t::sparse(unsigned char *output, size_t width, bool peek)
+    {
+        const auto start = offset;
+
+        // every failure, including a truncated value, leaves the reader where it started
+        try
+        {
+            const auto marker = uint8();
+
+            if (marker == SPARSE_POD_EMPTY)
+            {
+                std::memset(output, 0, width);
+            }
+            else if (marker == SPARSE_POD_DENSE)
+            {
+                bytes(output, width);
+            }
+            else if (marker == SPARSE_POD_BITMAP)
+            {
+                const auto bitmap_length = (width + 7) / 8;
+
+                require(bitmap_length);
+
+                const auto bitmap = data() + offset;
+
+                size_t count = 0;
+
+                for (size_t i = 0; i < bitmap_length; ++i)
+                {
+                    for (auto bits = bitmap[i]; bits != 0; bits &= static_cast<unsigned char>(bits - 1))
+                    {
+                        count++;
+                    }
+                }
+
+                // bits beyond the end of the value must not be set
+                if (width % 8 != 0 && (bitmap[bitmap_length - 1] >> (width % 8)) != 0)
+                {
+                    throw std::range_error("invalid sparse pod bitmap at position " + std::to_string(base + start));
+                }
+
+                require(bitmap_length + count);
+
+                std::memset(output, 0, width);
+
+                auto input = bitmap + bitmap_length;
+
+                for (size_t i = 0; i < bitmap_length; ++i)
+                {
+                    for (size_t j = 0; bitmap[i] >> j != 0; ++j)
+                    {
+                        if ((bitmap[i] >> j) & 1)
+                        {
+                            output[i * 8 + j] = *input++;
+                        }
+                    }
+                }
+
+                offset += bitmap_length + count;
+            }
+            else
+            {
+                throw std::range_error("invalid sparse pod marker at position " + std::to_string(base + start));
+            }
+        }
+        catch (...)
+        {
+            reset(start);
+
+            throw;
+        }
+
+        if (peek)
+        {
+            reset(start);
+        }
+    }
+
     std::string deserializer_t::to_string() const
     {
-        return to_hex(buffer.data(), buffer.size());
+        return to_hex(data(), size());
     }
 
     unsigned char deserializer_t::uint8(bool peek)
     {
+        require(sizeof(unsigned char));
+
         const auto start = offset;
 
         if (!peek)
@@ -111,11 +341,13 @@ namespace Serialization
             offset += sizeof(unsigned char);
         }
 
-        return unpack<unsigned char>(buffer, start);
+        return unpack<unsigned char>(data(), size(), start);
     }
 
     uint16_t deserializer_t::uint16(bool peek, bool big_endian)
     {
+        require(sizeof(uint16_t));
+
         const auto start = offset;
 
         if (!peek)
@@ -123,11 +355,27 @@ namespace Serialization
             offset += sizeof(uint16_t);
         }
 
-        return unpack<uint16_t>(buffer, start, big_endian);
+        return unpack<uint16_t>(data(), size(), start, big_endian);
+    }
+
+    void deserializer_t::uint16(uint16_t *output, size_t count, bool peek, bool big_endian)
+    {
+        fixed(output, count, sizeof(uint16_t), peek, big_endian);
+    }
+
+    std::vector<uint16_t> deserializer_t::uint16V(bool peek, bool big_endian)
+    {
+        std::vector<uint16_t> result;
+
+        uint16V(result, peek, big_endian);
+
+        return result;
     }
 
     uint32_t deserializer_t::uint32(bool peek, bool big_endian)
     {
+        require(sizeof(uint32_t));
+
         const auto start = offset;
 
         if (!peek)
@@ -135,11 +383,27 @@ namespace Serialization
             offset += sizeof(uint32_t);
         }
 
-        return unpack<uint32_t>(buffer, start, big_endian);
+        return unpack<uint32_t>(data(), size(), start, big_endian);
+    }
+
+    void deserializer_t::uint32(uint32_t *output, size_t count, bool peek, bool big_endian)
+    {
+        fixed(output, count, sizeof(uint32_t), peek, big_endian);
+    }
+
+    std::vector<uint32_t> deserializer_t::uint32V(bool peek, bool big_endian)
+    {
+        std::vector<uint32_t> result;
+
+        uint32V(result, peek, big_endian);
+
+        return result;
     }
 
     uint64_t deserializer_t::uint64(bool peek, bool big_endian)
     {
+        require(sizeof(uint64_t));
+
         const auto start = offset;
 
         if (!peek)
@@ -147,42 +411,67 @@ namespace Serialization
             offset += sizeof(uint64_t);
         }
 
-        return unpack<uint64_t>(buffer, start, big_endian);
+        return unpack<uint64_t>(data(), size(), start, big_endian);
+    }
+
+    void deserializer_t::uint64(uint64_t *output, size_t count, bool peek, bool big_endian)
+    {
+        fixed(output, count, sizeof(uint64_t), peek, big_endian);
+    }
+
+    std::vector<uint64_t> deserializer_t::uint64V(bool peek, bool big_endian)
+    {
+        std::vector<uint64_t> result;
+
+        uint64V(result, peek, big_endian);
+
+        return result;
     }
 
     uint128_t deserializer_t::uint128(bool peek, bool big_endian)
     {
+        constexpr auto width = limb_count<uint128_t>() * sizeof(uint64_t);
+
+        require(width);
+
         const auto start = offset;
 
         if (!peek)
         {
-            offset += sizeof(uint128_t);
+            offset += width;
         }
 
-        return unpack<uint128_t>(buffer, start, big_endian);
+        return unpack_limbs<uint128_t>(data() + start, big_endian);
     }
 
     uint256_t deserializer_t::uint256(bool peek, bool big_endian)
     {
+        constexpr auto width = limb_count<uint256_t>() * sizeof(uint64_t);
+
+        require(width);
+
         const auto start = offset;
 
         if (!peek)
         {
-            offset += sizeof(uint256_t);
+            offset += width;
         }
 
-        return unpack<uint256_t>(buffer, start, big_endian);
+        return unpack_limbs<uint256_t>(data() + start, big_endian);
     }
 
     size_t deserializer_t::unread_bytes() const
     {
-        const auto unread = buffer.size() - offset;
-
-        return (unread >= 0) ? unread : 0;
+        return (offset < length) ? length - offset : 0;
     }
 
     std::vector<unsigned char> deserializer_t::unread_data() const
     {
-        return {buffer.begin() + offset, buffer.end()};
+        if (offset >= length)
+        {
+            return {};
+        }
+
+        return {data() + offset, data() + length};
     }
 } // namespace Serialization
@@ -0,0 +1,489 @@
+// Copyright (c) 2020-2024, Brandon Lehmann
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <iterator>
+#include <record_stream.h>
+
+namespace Serialization
+{
+    // the kind of each frame, held in the lowest two bits of its header
+    static constexpr uint8_t FRAME_RECORD = 0, FRAME_INDEX = 1, FRAME_FOOTER = 2;
+
+    // the record count, the offset of the last index block, and the magic number
+    static constexpr uint64_t FOOTER_BODY_SIZE = 2 * sizeof(uint64_t) + sizeof(uint32_t);
+
+    // a footer's header always fits in a single varint byte, so footers are always the same size
+    static constexpr uint64_t FOOTER_SIZE = 1 + FOOTER_BODY_SIZE;
+
+    static constexpr uint32_t FOOTER_MAGIC = 0x31535253;
+
+    static constexpr uint64_t NO_INDEX = UINT64_MAX;
+
+    /**
+     * Returns the length of the stream, leaving its read position at the end
+     */
+    static uint64_t stream_length(std::istream &stream)
+    {
+        stream.seekg(0, std::ios::end);
+
+        const auto length = stream.tellg();
+
+        if (!stream || length < 0)
+        {
+            throw std::runtime_error("unable to seek within record stream");
+        }
+
+        return uint64_t(length);
+    }
+
+    /**
+     * Reads the footer at the end of a stream of the given length, returning the record count and the
+     * offset of the last index block
+     */
+    static std::tuple<uint64_t, uint64_t> read_footer(std::istream &stream, uint64_t length)
+    {
+        if (length < FOOTER_SIZE)
+        {
+            throw std::range_error("record stream does not end in a footer");
+        }
+
+        unsigned char footer[FOOTER_SIZE];
+
+        stream.seekg(std::streamoff(length - FOOTER_SIZE));
+
+        stream.read(reinterpret_cast<char *>(footer), FOOTER_SIZE);
+
+        if (!stream)
+        {
+            throw std::runtime_error("unable to read record stream footer");
+        }
+
+        deserializer_t reader(std::vector<unsigned char>(footer, footer + FOOTER_SIZE));
+
+        if (reader.uint8() != ((FOOTER_BODY_SIZE << 2) | FRAME_FOOTER))
+        {
+            throw std::range_error("record stream does not end in a footer");
+        }
+
+        const auto count = reader.uint64(), last_index = reader.uint64();
+
+        if (reader.uint32() != FOOTER_MAGIC || (last_index != NO_INDEX && last_index >= length))
+        {
+            throw std::range_error("record stream does not end in a footer");
+        }
+
+        return {count, last_index};
+    }
+
+    record_stream_writer_t::record_stream_writer_t(std::iostream &stream, size_t stride, size_t block_size):
+        stream(stream), stride(stride), block_size(block_size), last_index(NO_INDEX)
+    {
+        if (stride == 0 || block_size == 0)
+        {
+            throw std::invalid_argument("stride and block size must be greater than zero");
+        }
+
+        const auto length = stream_length(stream);
+
+        if (length != 0)
+        {
+            std::tie(count, last_index) = read_footer(stream, length);
+        }
+
+        stream.seekp(0, std::ios::end);
+
+        if (!stream)
+        {
+            throw std::runtime_error("unable to seek within record stream");
+        }
+    }
+
+    record_stream_writer_t::~record_stream_writer_t()
+    {
+        if (dirty)
+        {
+            try
+            {
+                close();
+            }
+            catch (...)
+            {
+            }
+        }
+    }
+
+    void record_stream_writer_t::append(const serializer_t &record)
+    {
+        this->record(record.segments());
+    }
+
+    void record_stream_writer_t::append(const void *data, size_t length)
+    {
+        record({{static_cast<const unsigned char *>(data), length}});
+    }
+
+    void record_stream_writer_t::close()
+    {
+        index();
+
+        serializer_t footer;
+
+        footer.uint64(count);
+
+        footer.uint64(last_index);
+
+        footer.uint32(FOOTER_MAGIC);
+
+        header(FRAME_FOOTER, footer.size());
+
+        write(footer.data(), footer.size());
+
+        stream.flush();
+
+        dirty = false;
+    }
+
+    void record_stream_writer_t::header(uint8_t kind, uint64_t length)
+    {
+        if (length > (UINT64_MAX >> 2))
+        {
+            throw std::range_error("record is too large");
+        }
+
+        const auto bytes = encode_varint((length << 2) | kind);
+
+        write(bytes.data(), bytes.size());
+    }
+
+    void record_stream_writer_t::index()
+    {
+        if (pending.empty())
+        {
+            return;
+        }
+
+        const auto position = uint64_t(stream.tellp());
+
+        serializer_t block;
+
+        block.uint64(last_index);
+
+        block.varint(pending.size());
+
+        for (const auto &entry : pending)
+        {
+            block.uint64(entry.record);
+
+            block.uint64(entry.offset);
+        }
+
+        header(FRAME_INDEX, block.size());
+
+        write(block.data(), block.size());
+
+        last_index = position;
+
+        pending.clear();
+    }
+
+    void record_stream_writer_t::record(const std::vector<buffer_segment_t> &segments)
+    {
+        if (count % stride == 0)
+        {
+            pending.push_back({count, uint64_t(stream.tellp())});
+        }
+
+        uint64_t length = 0;
+
+        for (const auto &segment : segments)
+        {
+            length += segment.length;
+        }
+
+        header(FRAME_RECORD, length);
+
+        for (const auto &segment : segments)
+        {
+            write(segment.data, segment.length);
+        }
+
+        count++;
+
+        dirty = true;
+
+        if (pending.size() == block_size)
+        {
+            index();
+        }
+    }
+
+    uint64_t record_stream_writer_t::size() const
+    {
+        return count;
+    }
+
+    void record_stream_writer_t::write(const void *data, size_t length)
+    {
+        stream.write(static_cast<const char *>(data), std::streamsize(length));
+
+        if (!stream)
+        {
+            throw std::runtime_error("unable to write to record stream");
+        }
+    }
+
+    record_stream_reader_t::record_stream_reader_t(std::istream &stream): stream(stream)
+    {
+        end = stream_length(stream);
+
+        if (end != 0)
+        {
+            uint64_t offset;
+
+            std::tie(count, offset) = read_footer(stream, end);
+
+            // follow the chain of index blocks from the last to the first
+            std::vector<std::vector<record_stream_entry_t>> blocks;
+
+            while (offset != NO_INDEX)
+            {
+                stream.seekg(std::streamoff(offset));
+
+                uint8_t kind;
+
+                uint64_t length;
+
+                if (!header(kind, length) || kind != FRAME_INDEX)
+                {
+                    throw std::range_error("invalid index block at offset " + std::to_string(offset));
+                }
+
+                buffer.resize(length);
+
+                stream.read(reinterpret_cast<char *>(buffer.data()), std::streamsize(length));
+
+                if (!stream)
+                {
+                    throw std::runtime_error("unable to read from record stream");
+                }
+
+                deserializer_t reader(buffer);
+
+                const auto previous = reader.uint64();
+
+                const auto total = reader.varint<uint64_t>();
+
+                // every entry occupies two uint64s, so refuse counts that cannot possibly be satisfied
+                if (total > reader.unread_bytes() / (2 * sizeof(uint64_t))
+                    || (previous != NO_INDEX && previous >= offset))
+                {
+                    throw std::range_error("invalid index block at offset " + std::to_string(offset));
+                }
+
+                auto &block = blocks.emplace_back(total);
+
+                for (auto &entry : block)
+                {
+                    entry.record = reader.uint64();
+
+                    entry.offset = reader.uint64();
+                }
+
+                offset = previous;
+            }
+
+            for (auto block = blocks.rbegin(); block != blocks.rend(); ++block)
+            {
+                entries.insert(entries.end(), block->begin(), block->end());
+            }
+
+            for (size_t i = 0; i < entries.size(); ++i)
+            {
+                if (entries[i].offset >= end || entries[i].record >= count
+                    || (i != 0 && entries[i].record <= entries[i - 1].record))
+                {
+                    throw std::range_error("invalid record stream index");
+                }
+            }
+        }
+
+        seek(0);
+    }
+
+    const std::vector<record_stream_entry_t> &record_stream_reader_t::boundaries() const
+    {
+        return entries;
+    }
+
+    bool record_stream_reader_t::header(uint8_t &kind, uint64_t &length)
+    {
+        uint64_t value = 0;
+
+        for (size_t shift = 0;; shift += 7)
+        {
+            const auto byte = stream.get();
+
+            if (byte == std::char_traits<char>::eof())
+            {
+                if (shift == 0)
+                {
+                    stream.clear();
+
+                    return false;
+                }
+
+                throw std::range_error("truncated record stream frame header");
+            }
+
+            if (shift > 63 || (shift == 63 && (byte & 0x7e) != 0))
+            {
+                throw std::range_error("invalid record stream frame header");
+            }
+
+            value |= uint64_t(byte & 0x7f) << shift;
+
+            if ((byte & 0x80) == 0)
+            {
+                break;
+            }
+        }
+
+        kind = static_cast<uint8_t>(value & 3);
+
+        length = value >> 2;
+
+        if (length > end - uint64_t(stream.tellg()))
+        {
+            throw std::range_error("truncated record stream frame");
+        }
+
+        return true;
+    }
+
+    bool record_stream_reader_t::next(deserializer_t &record)
+    {
+        if (!next(buffer))
+        {
+            return false;
+        }
+
+        record.assign(buffer);
+
+        return true;
+    }
+
+    bool record_stream_reader_t::next(std::vector<unsigned char> &record)
+    {
+        uint8_t kind;
+
+        uint64_t length;
+
+        while (current < count && header(kind, length))
+        {
+            // index blocks and the footers of earlier appends are skipped
+            if (kind != FRAME_RECORD)
+            {
+                stream.seekg(std::streamoff(length), std::ios::cur);
+
+                continue;
+            }
+
+            record.resize(length);
+
+            stream.read(reinterpret_cast<char *>(record.data()), std::streamsize(length));
+
+            if (!stream)
+            {
+                throw std::runtime_error("unable to read from record stream");
+            }
+
+            current++;
+
+            return true;
+        }
+
+        return false;
+    }
+
+    uint64_t record_stream_reader_t::position() const
+    {
+        return current;
+    }
+
+    void record_stream_reader_t::seek(uint64_t record)
+    {
+        if (record > count)
+        {
+            throw std::out_of_range("record out of range");
+        }
+
+        // binary search for the last indexed record at or before the requested one
+        const auto entry = std::upper_bound(
+            entries.begin(),
+            entries.end(),
+            record,
+            [](uint64_t value, const record_stream_entry_t &other) { return value < other.record; });
+
+        if (entry == entries.begin())
+        {
+            stream.seekg(0);
+
+            current = 0;
+        }
+        else
+        {
+            stream.seekg(std::streamoff(std::prev(entry)->offset));
+
+            current = std::prev(entry)->record;
+        }
+
+        // then skip forward over the records in between
+        uint8_t kind;
+
+        uint64_t length;
+
+        while (current < record && header(kind, length))
+        {
+            stream.seekg(std::streamoff(length), std::ios::cur);
+
+            if (kind == FRAME_RECORD)
+            {
+                current++;
+            }
+        }
+
+        if (!stream)
+        {
+            throw std::runtime_error("unable to seek within record stream");
+        }
+    }
+
+    uint64_t record_stream_reader_t::size() const
+    {
+        return count;
+    }
+} // namespace Serialization
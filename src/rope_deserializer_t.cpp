@@ -0,0 +1,259 @@
+// Copyright (c) 2020-2024, Brandon Lehmann
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <rope_deserializer_t.h>
+
+namespace Serialization
+{
+    rope_deserializer_t::rope_deserializer_t(std::vector<std::vector<unsigned char>> &&chunks)
+    {
+        for (auto &chunk : chunks)
+        {
+            append(std::move(chunk));
+        }
+    }
+
+    rope_deserializer_t::rope_deserializer_t(const std::vector<buffer_segment_t> &segments)
+    {
+        for (const auto &segment : segments)
+        {
+            // empty segments are dropped so that the cursor never rests on one
+            if (segment.length == 0)
+            {
+                continue;
+            }
+
+            this->segments.push_back(segment);
+
+            starts.push_back(length);
+
+            length += segment.length;
+        }
+    }
+
+    rope_deserializer_t::rope_deserializer_t(const rope_deserializer_t &other):
+        chunks(other.chunks),
+        starts(other.starts),
+        length(other.length),
+        offset(other.offset),
+        segment(other.segment),
+        position(other.position)
+    {
+        segments.reserve(other.segments.size());
+
+        // owned chunks appear in the segments in the order they were appended, so each segment that
+        // references the next owned chunk of the source is redirected to the same chunk of the copy
+        size_t chunk = 0;
+
+        for (const auto &current : other.segments)
+        {
+            if (chunk < other.chunks.size() && current.data == other.chunks[chunk].data())
+            {
+                segments.push_back({chunks[chunk].data(), chunks[chunk].size()});
+
+                chunk++;
+            }
+            else
+            {
+                segments.push_back(current);
+            }
+        }
+    }
+
+    rope_deserializer_t &rope_deserializer_t::operator=(const rope_deserializer_t &other)
+    {
+        if (this != &other)
+        {
+            *this = rope_deserializer_t(other);
+        }
+
+        return *this;
+    }
+
+    void rope_deserializer_t::append(std::vector<unsigned char> &&chunk)
+    {
+        if (chunk.empty())
+        {
+            return;
+        }
+
+        const auto was_at_end = segment == segments.size();
+
+        chunks.push_back(std::move(chunk));
+
+        // moving a vector leaves its data in place, so the segments of earlier chunks remain valid
+        segments.push_back({chunks.back().data(), chunks.back().size()});
+
+        starts.push_back(length);
+
+        length += chunks.back().size();
+
+        if (was_at_end)
+        {
+            reset(offset);
+        }
+    }
+
+    bool rope_deserializer_t::boolean(bool peek)
+    {
+        return uint8(peek) == 1;
+    }
+
+    std::vector<unsigned char> rope_deserializer_t::bytes(size_t count, bool peek)
+    {
+        std::vector<unsigned char> result(count);
+
+        bytes(result.data(), count, peek);
+
+        return result;
+    }
+
+    void rope_deserializer_t::bytes(void *output, size_t count, bool peek)
+    {
+        require(count);
+
+        auto *out = static_cast<unsigned char *>(output);
+
+        auto current = segment, current_position = position;
+
+        for (size_t copied = 0; copied < count;)
+        {
+            const auto &source = segments[current];
+
+            const auto amount = std::min(source.length - current_position, count - copied);
+
+            std::memcpy(out + copied, source.data + current_position, amount);
+
+            copied += amount;
+
+            current_position += amount;
+
+            if (current_position == source.length)
+            {
+                current++;
+
+                current_position = 0;
+            }
+        }
+
+        if (!peek)
+        {
+            offset += count;
+
+            segment = current;
+
+            position = current_position;
+        }
+    }
+
+    std::string rope_deserializer_t::hex(size_t length, bool peek)
+    {
+        const auto temp = bytes(length, peek);
+
+        return to_hex(temp.data(), temp.size());
+    }
+
+    void rope_deserializer_t::require(size_t count) const
+    {
+        if (count > unread_bytes())
+        {
+            throw std::range_error("not enough data to complete request at position " + std::to_string(offset));
+        }
+    }
+
+    void rope_deserializer_t::reset(size_t position)
+    {
+        offset = position;
+
+        if (offset >= length)
+        {
+            segment = segments.size();
+
+            this->position = 0;
+
+            return;
+        }
+
+        segment = std::upper_bound(starts.begin(), starts.end(), offset) - starts.begin() - 1;
+
+        this->position = offset - starts[segment];
+    }
+
+    size_t rope_deserializer_t::size() const
+    {
+        return length;
+    }
+
+    void rope_deserializer_t::skip(size_t count)
+    {
+        // fast path: the skip stays within the current segment
+        if (segment < segments.size() && count < segments[segment].length - position)
+        {
+            offset += count;
+
+            position += count;
+
+            return;
+        }
+
+        reset(offset + count);
+    }
+
+    unsigned char rope_deserializer_t::uint8(bool peek)
+    {
+        return fixed<unsigned char>(peek, false);
+    }
+
+    uint16_t rope_deserializer_t::uint16(bool peek, bool big_endian)
+    {
+        return fixed<uint16_t>(peek, big_endian);
+    }
+
+    uint32_t rope_deserializer_t::uint32(bool peek, bool big_endian)
+    {
+        return fixed<uint32_t>(peek, big_endian);
+    }
+
+    uint64_t rope_deserializer_t::uint64(bool peek, bool big_endian)
+    {
+        return fixed<uint64_t>(peek, big_endian);
+    }
+
+    uint128_t rope_deserializer_t::uint128(bool peek, bool big_endian)
+    {
+        return fixed<uint128_t>(peek, big_endian);
+    }
+
+    uint256_t rope_deserializer_t::uint256(bool peek, bool big_endian)
+    {
+        return fixed<uint256_t>(peek, big_endian);
+    }
+
+    size_t rope_deserializer_t::unread_bytes() const
+    {
+        return (offset < length) ? length - offset : 0;
+    }
+} // namespace Serialization
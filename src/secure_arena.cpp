@@ -0,0 +1,147 @@
+// Copyright (c) 2020-2024, Brandon Lehmann
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cstdint>
+#include <secure_arena.h>
+#include <secure_erase.h>
+
+namespace Serialization
+{
+    static thread_local const secure_arena_t *active_arena = nullptr;
+
+    secure_arena_t::scope_t::scope_t(const secure_arena_t &arena): previous(active_arena)
+    {
+        active_arena = &arena;
+    }
+
+    secure_arena_t::scope_t::~scope_t()
+    {
+        active_arena = previous;
+    }
+
+    secure_arena_t::secure_arena_t(size_t initial_size, std::pmr::memory_resource *upstream):
+        upstream(upstream), next_size(std::max(initial_size, size_t(64)))
+    {
+    }
+
+    secure_arena_t::~secure_arena_t()
+    {
+        release();
+    }
+
+    bool secure_arena_t::contains(const void *pointer) const
+    {
+        const auto *value = static_cast<const unsigned char *>(pointer);
+
+        for (const auto &[block, length] : blocks)
+        {
+            if (value >= block && value < block + length)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool secure_arena_t::covers(const void *pointer)
+    {
+        return active_arena != nullptr && active_arena->contains(pointer);
+    }
+
+    void *secure_arena_t::do_allocate(size_t bytes, size_t alignment)
+    {
+        if (!blocks.empty())
+        {
+            const auto &[block, length] = blocks.back();
+
+            const auto address = reinterpret_cast<uintptr_t>(block) + used;
+
+            const auto padding = (alignment - (address % alignment)) % alignment;
+
+            if (used + padding + bytes <= length)
+            {
+                used += padding + bytes;
+
+                return block + used - bytes;
+            }
+        }
+
+        // blocks grow geometrically so that contains() and release() only ever visit a handful of them
+        while (next_size < bytes + alignment)
+        {
+            next_size *= 2;
+        }
+
+        auto *block = static_cast<unsigned char *>(upstream->allocate(next_size, alignof(std::max_align_t)));
+
+        blocks.emplace_back(block, next_size);
+
+        next_size *= 2;
+
+        used = 0;
+
+        return do_allocate(bytes, alignment);
+    }
+
+    void secure_arena_t::do_deallocate(void *pointer, size_t bytes, size_t)
+    {
+        // the memory is never reused, but it is wiped now rather than left behind until release()
+        secure_erase(pointer, bytes);
+    }
+
+    bool secure_arena_t::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+    {
+        return this == &other;
+    }
+
+    void secure_arena_t::release()
+    {
+        for (const auto &[block, length] : blocks)
+        {
+            secure_erase(block, length);
+
+            upstream->deallocate(block, length, alignof(std::max_align_t));
+        }
+
+        blocks.clear();
+
+        used = 0;
+    }
+
+    size_t secure_arena_t::size() const
+    {
+        size_t result = 0;
+
+        for (const auto &[block, length] : blocks)
+        {
+            result += length;
+        }
+
+        return result;
+    }
+} // namespace Serialization
@@ -24,20 +24,103 @@
 // STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
 // THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#ifndef __STDC_WANT_LIB_EXT1__
+#define __STDC_WANT_LIB_EXT1__ 1
+#endif
+
+#include <cstdint>
 #include <secure_erase.h>
+#include <string.h>
 
 #ifdef _MSC_VER
 #include <windows.h>
 #endif
 
-void secure_erase(void *pointer, size_t length)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SECURE_ERASE_STREAMING
+#endif
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 25))
+#define SECURE_ERASE_EXPLICIT_BZERO
+#elif defined(__OpenBSD__) || defined(__FreeBSD__)
+#define SECURE_ERASE_EXPLICIT_BZERO
+#endif
+
+// buffers at least this large are wiped using non-temporal stores so that they do not evict the cache
+#define SECURE_ERASE_STREAMING_THRESHOLD (8 * 1024 * 1024)
+
+/**
+ * Tells the compiler (including under LTO) that the memory may be read afterwards such that
+ * the stores that wiped it cannot be elided
+ */
+static inline void secure_erase_barrier(void *pointer)
 {
 #ifdef _MSC_VER
+    _ReadWriteBarrier();
+
+    (void)pointer;
+#else
+    __asm__ __volatile__("" : : "r"(pointer) : "memory");
+#endif
+}
+
+#ifdef SECURE_ERASE_STREAMING
+/**
+ * Wipes the memory using 16-byte non-temporal stores for the aligned body of the region
+ */
+static void secure_erase_streaming(unsigned char *pointer, size_t length)
+{
+    const auto head = (16 - (reinterpret_cast<uintptr_t>(pointer) & 15)) & 15;
+
+    std::memset(pointer, 0, head);
+
+    auto *block = reinterpret_cast<__m128i *>(pointer + head);
+
+    const auto blocks = (length - head) / 16;
+
+    const auto zero = _mm_setzero_si128();
+
+    for (size_t i = 0; i < blocks; ++i)
+    {
+        _mm_stream_si128(block + i, zero);
+    }
+
+    std::memset(pointer + head + blocks * 16, 0, length - head - blocks * 16);
+
+    // non-temporal stores are weakly ordered, make sure they are globally visible before returning
+    _mm_sfence();
+}
+#endif
+
+void secure_erase(void *pointer, size_t length)
+{
+    if (pointer == nullptr || length == 0)
+    {
+        return;
+    }
+
+#ifdef SECURE_ERASE_STREAMING
+    if (length >= SECURE_ERASE_STREAMING_THRESHOLD)
+    {
+        secure_erase_streaming(static_cast<unsigned char *>(pointer), length);
+
+        secure_erase_barrier(pointer);
+
+        return;
+    }
+#endif
+
+#if defined(_MSC_VER)
     SecureZeroMemory(pointer, length);
+#elif defined(SECURE_ERASE_EXPLICIT_BZERO)
+    explicit_bzero(pointer, length);
+#elif defined(__STDC_LIB_EXT1__) || defined(__APPLE__)
+    memset_s(pointer, length, 0, length);
 #else
     std::memset(pointer, 0, length);
+#endif
 
     // prevent compiler optimization
-    __asm__ __volatile__("" : : "r"(pointer) : "memory");
-#endif
+    secure_erase_barrier(pointer);
 }
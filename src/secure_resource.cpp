@@ -0,0 +1,226 @@
+// Copyright (c) 2020-2024, Brandon Lehmann
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <secure_erase.h>
+#include <cstdint>
+#include <mutex>
+#include <secure_resource.h>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace Serialization
+{
+    secure_resource_t::secure_resource_t(bool lock_memory, std::pmr::memory_resource *upstream):
+        lock_memory(lock_memory), upstream(upstream)
+    {
+    }
+
+    static size_t page_size()
+    {
+#ifdef _WIN32
+        SYSTEM_INFO info;
+
+        GetSystemInfo(&info);
+
+        static const auto size = size_t(info.dwPageSize);
+#else
+        static const auto size = size_t(sysconf(_SC_PAGESIZE));
+#endif
+
+        return size;
+    }
+
+    /**
+     * Page locks belong to the process rather than to a resource, so the number of live allocations on
+     * each locked page (keyed by page number) is tracked once for every instance; the table is never
+     * destroyed so that buffers released during static destruction can still be unlocked
+     */
+    struct page_table_t
+    {
+        std::mutex mutex;
+
+        std::unordered_map<uintptr_t, size_t> pages;
+    };
+
+    static page_table_t &page_table()
+    {
+        static auto *table = new page_table_t();
+
+        return *table;
+    }
+
+    /**
+     * Locks or unlocks the given run of pages, returning whether it succeeded
+     */
+    static bool lock_pages(uintptr_t first, uintptr_t count, bool locked)
+    {
+        auto *const address = reinterpret_cast<void *>(first * page_size());
+
+        const auto length = count * page_size();
+
+#ifdef _WIN32
+        return locked ? VirtualLock(address, length) != 0 : VirtualUnlock(address, length) != 0;
+#else
+        return locked ? mlock(address, length) == 0 : munlock(address, length) == 0;
+#endif
+    }
+
+    void *secure_resource_t::do_allocate(size_t bytes, size_t alignment)
+    {
+        auto *pointer = upstream->allocate(bytes, alignment);
+
+        if (lock_memory)
+        {
+            lock(pointer, bytes);
+        }
+
+        return pointer;
+    }
+
+    void secure_resource_t::do_deallocate(void *pointer, size_t bytes, size_t alignment)
+    {
+        secure_erase(pointer, bytes);
+
+        if (lock_memory)
+        {
+            unlock(pointer, bytes);
+        }
+
+        upstream->deallocate(pointer, bytes, alignment);
+    }
+
+    bool secure_resource_t::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+    {
+        return this == &other;
+    }
+
+    void secure_resource_t::lock(void *pointer, size_t bytes)
+    {
+        if (bytes == 0)
+        {
+            return;
+        }
+
+        const auto first = reinterpret_cast<uintptr_t>(pointer) / page_size();
+
+        const auto last = (reinterpret_cast<uintptr_t>(pointer) + bytes - 1) / page_size();
+
+        auto &table = page_table();
+
+        std::lock_guard<std::mutex> guard(table.mutex);
+
+        // lock each run of pages that are not yet in use with a single call
+        auto run = last + 1;
+
+        for (auto page = first; page <= last + 1; ++page)
+        {
+            const auto unused = page <= last && table.pages[page]++ == 0;
+
+            if (unused && run > last)
+            {
+                run = page;
+            }
+            else if (!unused && run <= last)
+            {
+                if (!lock_pages(run, page - run, true))
+                {
+                    failures++;
+                }
+
+                run = last + 1;
+            }
+        }
+    }
+
+    size_t secure_resource_t::lock_failures() const
+    {
+        std::lock_guard<std::mutex> guard(page_table().mutex);
+
+        return failures;
+    }
+
+    void secure_resource_t::unlock(void *pointer, size_t bytes)
+    {
+        if (bytes == 0)
+        {
+            return;
+        }
+
+        const auto first = reinterpret_cast<uintptr_t>(pointer) / page_size();
+
+        const auto last = (reinterpret_cast<uintptr_t>(pointer) + bytes - 1) / page_size();
+
+        auto &table = page_table();
+
+        std::lock_guard<std::mutex> guard(table.mutex);
+
+        // unlock each run of pages that no other allocation still uses with a single call
+        auto run = last + 1;
+
+        for (auto page = first; page <= last + 1; ++page)
+        {
+            auto released = false;
+
+            if (page <= last)
+            {
+                const auto entry = table.pages.find(page);
+
+                if (entry != table.pages.end() && --entry->second == 0)
+                {
+                    table.pages.erase(entry);
+
+                    released = true;
+                }
+            }
+
+            if (released && run > last)
+            {
+                run = page;
+            }
+            else if (!released && run <= last)
+            {
+                lock_pages(run, page - run, false);
+
+                run = last + 1;
+            }
+        }
+    }
+
+    std::pmr::memory_resource *secure_resource(bool lock_memory)
+    {
+        static secure_resource_t unlocked(false, std::pmr::new_delete_resource());
+
+        static secure_resource_t locked(true, std::pmr::new_delete_resource());
+
+        return lock_memory ? &locked : &unlocked;
+    }
+} // namespace Serialization
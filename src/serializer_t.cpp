@@ -24,23 +24,51 @@
 // STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
 // THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <bit_stream.h>
+#include <byte_order.h>
+#include <secure_erase.h>
+#include <secure_resource.h>
 #include <serializer_t.h>
 
 namespace Serialization
 {
+    serializer_t::serializer_t():
+        buffer(BufferPool::enabled() ? BufferPool::acquire() : std::pmr::vector<unsigned char>()),
+        pooled(BufferPool::enabled())
+    {
+    }
+
     serializer_t::serializer_t(const serializer_t &writer)
     {
-        buffer = writer.vector();
+        buffer = writer.buffer;
+
+        nested = writer.nested;
+
+        gathered = writer.gathered;
+
+        gathered_bytes = writer.gathered_bytes;
+
+        threshold = writer.threshold;
     }
 
     serializer_t::serializer_t(std::initializer_list<unsigned char> input)
     {
-        buffer = std::vector<unsigned char>(input);
+        buffer.assign(input.begin(), input.end());
     }
 
     serializer_t::serializer_t(const std::vector<unsigned char> &input)
     {
-        buffer = input;
+        buffer.assign(input.begin(), input.end());
+    }
+
+    serializer_t::serializer_t(std::pmr::memory_resource *resource): buffer(resource) {}
+
+    serializer_t::~serializer_t()
+    {
+        if (pooled)
+        {
+            BufferPool::release(std::move(buffer));
+        }
     }
 
     unsigned char &serializer_t::operator[](int i)
@@ -53,8 +81,20 @@ namespace Serialization
         return buffer[i];
     }
 
+    void serializer_t::begin_nested(bool fixed_width)
+    {
+        nested.emplace_back(buffer.size(), fixed_width, gathered_bytes);
+
+        // reserve the prefix slot: a full uint32 in fixed width mode, otherwise a single varint byte
+        grow(sizeof(uint32_t));
+
+        buffer.resize(buffer.size() + (fixed_width ? sizeof(uint32_t) : 1), 0);
+    }
+
     void serializer_t::boolean(bool value)
     {
+        grow(1);
+
         if (value)
         {
             buffer.push_back(1);
@@ -65,19 +105,128 @@ namespace Serialization
         }
     }
 
+    void serializer_t::boolean(const std::vector<bool> &values)
+    {
+        varint(values.size());
+
+        bit_writer_t writer(*this);
+
+        writer.flags(values);
+    }
+
     void serializer_t::bytes(const void *data, size_t length)
     {
         auto const *raw = static_cast<unsigned char const *>(data);
 
-        for (size_t i = 0; i < length; ++i)
+        if (threshold != 0 && length >= threshold)
         {
-            buffer.push_back(raw[i]);
+            gathered.emplace_back(buffer.size(), raw, length);
+
+            gathered_bytes += length;
+
+            return;
         }
+
+        grow(length);
+
+        buffer.insert(buffer.end(), raw, raw + length);
     }
 
     void serializer_t::bytes(const std::vector<unsigned char> &value)
     {
-        extend(value);
+        bytes(value.data(), value.size());
+    }
+
+    std::vector<unsigned char> serializer_t::compressed(size_t chunk_size) const
+    {
+        if (chunk_size == 0 || chunk_size > UINT32_MAX)
+        {
+            throw std::invalid_argument("chunk size must be between 1 byte and 4 GiB");
+        }
+
+        std::vector<unsigned char> result, staging;
+
+        result.reserve(Compression::bound(size()) + (size() / chunk_size + 2) * 2 * sizeof(uint32_t));
+
+        const auto write_header = [&](size_t position, size_t length, size_t stored)
+        {
+            for (size_t i = 0; i < sizeof(uint32_t); ++i)
+            {
+                result[position + i] = static_cast<unsigned char>(length >> (i * 8));
+
+                result[position + sizeof(uint32_t) + i] = static_cast<unsigned char>(stored >> (i * 8));
+            }
+        };
+
+        const auto write_chunk = [&](const unsigned char *data, size_t length)
+        {
+            const auto position = result.size(), start = position + 2 * sizeof(uint32_t);
+
+            result.resize(start + Compression::bound(length));
+
+            auto stored = Compression::compress(data, length, result.data() + start);
+
+            // store chunks that do not compress as they are
+            if (stored >= length)
+            {
+                std::memcpy(result.data() + start, data, length);
+
+                stored = length;
+            }
+
+            result.resize(start + stored);
+
+            write_header(position, length, stored);
+        };
+
+        for (const auto &segment : segments())
+        {
+            auto data = segment.data;
+
+            auto remaining = segment.length;
+
+            while (remaining != 0)
+            {
+                // compress whole chunks in place, staging only those that straddle a segment boundary
+                if (staging.empty() && remaining >= chunk_size)
+                {
+                    write_chunk(data, chunk_size);
+
+                    data += chunk_size;
+
+                    remaining -= chunk_size;
+
+                    continue;
+                }
+
+                const auto count = std::min(chunk_size - staging.size(), remaining);
+
+                staging.insert(staging.end(), data, data + count);
+
+                data += count;
+
+                remaining -= count;
+
+                if (staging.size() == chunk_size)
+                {
+                    write_chunk(staging.data(), staging.size());
+
+                    staging.clear();
+                }
+            }
+        }
+
+        if (!staging.empty())
+        {
+            write_chunk(staging.data(), staging.size());
+        }
+
+        // terminated by a chunk of zero length
+        result.resize(result.size() + 2 * sizeof(uint32_t));
+
+        write_header(result.size() - 2 * sizeof(uint32_t), 0, 0);
+
+        return result;
     }
 
     const unsigned char *serializer_t::data() const
@@ -85,12 +234,89 @@ namespace Serialization
         return buffer.data();
     }
 
-    void serializer_t::extend(const std::vector<unsigned char> &vector)
+    void serializer_t::end_nested()
     {
-        for (const auto &element : vector)
+        if (nested.empty())
         {
-            buffer.push_back(element);
+            throw std::runtime_error("no nested structure to end");
+        }
+
+        const auto [position, fixed_width, gathered_start] = nested.back();
+
+        nested.pop_back();
+
+        // any gathered segments written since the structure began are part of its body
+        const auto gathered_length = gathered_bytes - gathered_start;
+
+        if (fixed_width)
+        {
+            const auto length = buffer.size() - position - sizeof(uint32_t) + gathered_length;
+
+            if (length > UINT32_MAX)
+            {
+                throw std::range_error("nested structure too large for fixed width prefix");
+            }
+
+            const auto packed = pack(static_cast<uint32_t>(length));
+
+            std::copy(packed.begin(), packed.end(), buffer.begin() + position);
+
+            return;
         }
+
+        const auto length = buffer.size() - position - 1 + gathered_length;
+
+        const auto prefix = encode_varint(length);
+
+        // the reserved single byte was not enough, shift the body over once to make room
+        if (prefix.size() > 1)
+        {
+            buffer.insert(buffer.begin() + position + 1, prefix.size() - 1, 0);
+
+            for (auto &[segment_position, segment_data, segment_length] : gathered)
+            {
+                if (segment_position > position)
+                {
+                    segment_position += prefix.size() - 1;
+                }
+            }
+        }
+
+        std::copy(prefix.begin(), prefix.end(), buffer.begin() + position);
+    }
+
+    void serializer_t::expand(size_t additional)
+    {
+        // every reallocation of a secure buffer wipes the old one, so grow those in large geometric steps
+        if (dynamic_cast<secure_resource_t *>(buffer.get_allocator().resource()) == nullptr)
+        {
+            return;
+        }
+
+        buffer.reserve(std::max({buffer.capacity() * 2, buffer.size() + additional, secure_resource_t::GROWTH}));
+    }
+
+    void serializer_t::extend(const std::vector<unsigned char> &vector)
+    {
+        grow(vector.size());
+
+        buffer.insert(buffer.end(), vector.begin(), vector.end());
+    }
+
+    void serializer_t::extend_fixed(const void *values, size_t count, size_t width, bool big_endian)
+    {
+        const auto position = buffer.size();
+
+        grow(count * width);
+
+        buffer.resize(position + count * width);
+
+        ByteOrder::copy(values, buffer.data() + position, count, width, big_endian);
+    }
+
+    void serializer_t::gather_threshold(size_t value)
+    {
+        threshold = value;
     }
 
     void serializer_t::hex(const std::string &value)
@@ -100,23 +326,172 @@ namespace Serialization
         extend(bytes);
     }
 
+#ifndef _WIN32
+    std::vector<struct iovec> serializer_t::iovecs() const
+    {
+        std::vector<struct iovec> result;
+
+        for (const auto &segment : segments())
+        {
+            result.push_back({const_cast<unsigned char *>(segment.data), segment.length});
+        }
+
+        return result;
+    }
+#endif
+
+    void serializer_t::reserve(size_t capacity)
+    {
+        buffer.reserve(capacity);
+    }
+
     void serializer_t::reset()
     {
         buffer.clear();
+
+        nested.clear();
+
+        gathered.clear();
+
+        gathered_bytes = 0;
+    }
+
+    std::pmr::memory_resource *serializer_t::resource() const
+    {
+        return buffer.get_allocator().resource();
+    }
+
+    std::vector<buffer_segment_t> serializer_t::segments() const
+    {
+        std::vector<buffer_segment_t> result;
+
+        size_t position = 0;
+
+        for (const auto &[segment_position, segment_data, segment_length] : gathered)
+        {
+            if (segment_position > position)
+            {
+                result.push_back({buffer.data() + position, segment_position - position});
+            }
+
+            result.push_back({segment_data, segment_length});
+
+            position = segment_position;
+        }
+
+        if (buffer.size() > position)
+        {
+            result.push_back({buffer.data() + position, buffer.size() - position});
+        }
+
+        return result;
+    }
+
+    void serializer_t::secure_reset()
+    {
+        secure_erase(buffer.data(), buffer.capacity());
+
+        reset();
     }
 
     size_t serializer_t::size() const
     {
-        return buffer.size();
+        return buffer.size() + gathered_bytes;
+    }
+
+    void serializer_t::sparse(const unsigned char *data, size_t length)
+    {
+        grow(1 + length);
+
+        const auto position = buffer.size();
+
+        // count the non-zero bytes a word at a time by folding each byte onto its lowest bit
+        size_t count = 0, i = 0;
+
+        for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t))
+        {
+            uint64_t word;
+
+            std::memcpy(&word, data + i, sizeof(word));
+
+            word |= word >> 4;
+
+            word |= word >> 2;
+
+            word |= word >> 1;
+
+            count += ((word & 0x0101010101010101ull) * 0x0101010101010101ull) >> 56;
+        }
+
+        for (; i < length; ++i)
+        {
+            count += data[i] != 0;
+        }
+
+        if (count == 0)
+        {
+            buffer.push_back(SPARSE_POD_EMPTY);
+
+            return;
+        }
+
+        const auto bitmap_length = (length + 7) / 8;
+
+        if (bitmap_length + count >= length)
+        {
+            buffer.push_back(SPARSE_POD_DENSE);
+
+            buffer.insert(buffer.end(), data, data + length);
+
+            return;
+        }
+
+        buffer.resize(position + 1 + bitmap_length + count, 0);
+
+        buffer[position] = SPARSE_POD_BITMAP;
+
+        const auto bitmap = buffer.data() + position + 1;
+
+        auto output = bitmap + bitmap_length;
+
+        for (i = 0; i < length; i += 8)
+        {
+            const auto width = std::min<size_t>(8, length - i);
+
+            // runs of zero bytes are skipped a word at a time
+            if (is_zero(data + i, width))
+            {
+                continue;
+            }
+
+            for (size_t j = 0; j < width; ++j)
+            {
+                if (data[i + j] != 0)
+                {
+                    bitmap[i / 8] |= static_cast<unsigned char>(1 << j);
+
+                    *output++ = data[i + j];
+                }
+            }
+        }
     }
 
     std::string serializer_t::to_string() const
     {
-        return to_hex(buffer.data(), buffer.size());
+        if (gathered.empty())
+        {
+            return to_hex(buffer.data(), buffer.size());
+        }
+
+        const auto output = vector();
+
+        return to_hex(output.data(), output.size());
     }
 
     void serializer_t::uint8(const unsigned char &value)
     {
+        grow(1);
+
         buffer.push_back(value);
     }
 
@@ -127,6 +502,11 @@ namespace Serialization
         extend(packed);
     }
 
+    void serializer_t::uint16(const uint16_t *values, size_t count, bool big_endian)
+    {
+        extend_fixed(values, count, sizeof(uint16_t), big_endian);
+    }
+
     void serializer_t::uint32(const uint32_t &value, bool big_endian)
     {
         const auto packed = pack(value, big_endian);
@@ -134,6 +514,11 @@ namespace Serialization
         extend(packed);
     }
 
+    void serializer_t::uint32(const uint32_t *values, size_t count, bool big_endian)
+    {
+        extend_fixed(values, count, sizeof(uint32_t), big_endian);
+    }
+
     void serializer_t::uint64(const uint64_t &value, bool big_endian)
     {
         const auto packed = pack(value, big_endian);
@@ -141,22 +526,49 @@ namespace Serialization
         extend(packed);
     }
 
+    void serializer_t::uint64(const uint64_t *values, size_t count, bool big_endian)
+    {
+        extend_fixed(values, count, sizeof(uint64_t), big_endian);
+    }
+
     void serializer_t::uint128(const uint128_t &value, bool big_endian)
     {
-        const auto packed = pack(value, big_endian);
+        const auto position = buffer.size();
 
-        extend(packed);
+        grow(limb_count<uint128_t>() * sizeof(uint64_t));
+
+        buffer.resize(position + limb_count<uint128_t>() * sizeof(uint64_t));
+
+        pack_limbs(value, buffer.data() + position, big_endian);
     }
 
     void serializer_t::uint256(const uint256_t &value, bool big_endian)
     {
-        const auto packed = pack(value, big_endian);
+        const auto position = buffer.size();
 
-        extend(packed);
+        grow(limb_count<uint256_t>() * sizeof(uint64_t));
+
+        buffer.resize(position + limb_count<uint256_t>() * sizeof(uint64_t));
+
+        pack_limbs(value, buffer.data() + position, big_endian);
     }
 
     std::vector<unsigned char> serializer_t::vector() const
     {
-        return buffer;
+        if (gathered.empty())
+        {
+            return {buffer.begin(), buffer.end()};
+        }
+
+        std::vector<unsigned char> result;
+
+        result.reserve(size());
+
+        for (const auto &segment : segments())
+        {
+            result.insert(result.end(), segment.data, segment.data + segment.length);
+        }
+
+        return result;
     }
 } // namespace Serialization
@@ -0,0 +1,274 @@
+// Copyright (c) 2020-2024, Brandon Lehmann
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstring>
+#include <streamvbyte.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <tmmintrin.h>
+// the shuffle kernel is compiled for SSSE3 regardless of the target, as ARCH may name a baseline CPU
+// (or be "default", which passes no -march at all), and is selected at runtime unless the target
+// already guarantees SSSE3
+#define STREAMVBYTE_SSSE3 __attribute__((target("ssse3")))
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#include <tmmintrin.h>
+#define STREAMVBYTE_SSSE3
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define STREAMVBYTE_NEON
+#endif
+
+namespace Serialization::StreamVByte
+{
+    /**
+     * For every possible control byte, the number of data bytes used by its four values and the byte
+     * shuffle that expands those data bytes into four 32-bit values (0xff yields a zero byte)
+     */
+    struct tables_t
+    {
+        uint8_t length[256];
+
+        uint8_t shuffle[256][16];
+    };
+
+    static constexpr tables_t generate_tables()
+    {
+        tables_t tables = {};
+
+        for (size_t control = 0; control < 256; ++control)
+        {
+            uint8_t position = 0;
+
+            for (size_t value = 0; value < 4; ++value)
+            {
+                const auto length = uint8_t(((control >> (value * 2)) & 3) + 1);
+
+                for (uint8_t byte = 0; byte < 4; ++byte)
+                {
+                    tables.shuffle[control][value * 4 + byte] = byte < length ? uint8_t(position + byte) : 0xff;
+                }
+
+                position += length;
+            }
+
+            tables.length[control] = position;
+        }
+
+        return tables;
+    }
+
+    static constexpr tables_t tables = generate_tables();
+
+    static inline uint8_t length_code(uint32_t value)
+    {
+        return uint8_t((value > 0xff) + (value > 0xffff) + (value > 0xffffff));
+    }
+
+    /**
+     * Decodes the values of the control bytes in the range [first, last) one at a time
+     */
+    static inline size_t decode_scalar(
+        const unsigned char *control,
+        const unsigned char *data,
+        size_t first,
+        size_t last,
+        uint32_t *values)
+    {
+        size_t position = 0;
+
+        for (size_t i = first; i < last; ++i)
+        {
+            const auto length = size_t(((control[i / 4] >> ((i % 4) * 2)) & 3) + 1);
+
+            uint32_t value = 0;
+
+            for (size_t byte = 0; byte < length; ++byte)
+            {
+                value |= uint32_t(data[position + byte]) << (byte * 8);
+            }
+
+            values[i] = value;
+
+            position += length;
+        }
+
+        return position;
+    }
+
+#if defined(STREAMVBYTE_SSSE3)
+    static bool has_ssse3()
+    {
+#if defined(__SSSE3__)
+        return true;
+#else
+#if defined(__GNUC__) || defined(__clang__)
+        static const bool result = __builtin_cpu_supports("ssse3");
+#else
+        static const bool result = []()
+        {
+            int info[4];
+
+            __cpuid(info, 1);
+
+            return (info[2] & (1 << 9)) != 0;
+        }();
+#endif
+
+        return result;
+#endif
+    }
+
+    /**
+     * Decodes four values per control byte for as long as a full 16 byte load stays within the data
+     * stream, returning the number of control bytes consumed
+     */
+    STREAMVBYTE_SSSE3 static size_t decode_blocks(
+        const unsigned char *control,
+        const unsigned char *data,
+        size_t length,
+        size_t blocks,
+        uint32_t *values,
+        size_t &position)
+    {
+        size_t i = 0;
+
+        for (; i < blocks && position + 16 <= length; ++i)
+        {
+            const auto input = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + position));
+
+            const auto shuffle = _mm_loadu_si128(reinterpret_cast<const __m128i *>(tables.shuffle[control[i]]));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(values + i * 4), _mm_shuffle_epi8(input, shuffle));
+
+            position += tables.length[control[i]];
+        }
+
+        return i;
+    }
+#elif defined(STREAMVBYTE_NEON)
+    static size_t decode_blocks(
+        const unsigned char *control,
+        const unsigned char *data,
+        size_t length,
+        size_t blocks,
+        uint32_t *values,
+        size_t &position)
+    {
+        size_t i = 0;
+
+        for (; i < blocks && position + 16 <= length; ++i)
+        {
+            const auto input = vld1q_u8(data + position);
+
+            const auto shuffle = vld1q_u8(tables.shuffle[control[i]]);
+
+            vst1q_u8(reinterpret_cast<uint8_t *>(values + i * 4), vqtbl1q_u8(input, shuffle));
+
+            position += tables.length[control[i]];
+        }
+
+        return i;
+    }
+#endif
+
+    size_t data_size(const unsigned char *control, size_t count)
+    {
+        size_t result = 0;
+
+        for (size_t i = 0; i < count / 4; ++i)
+        {
+            result += tables.length[control[i]];
+        }
+
+        for (size_t i = count - count % 4; i < count; ++i)
+        {
+            result += ((control[i / 4] >> ((i % 4) * 2)) & 3) + 1;
+        }
+
+        return result;
+    }
+
+    size_t decode(
+        const unsigned char *control,
+        const unsigned char *data,
+        size_t length,
+        size_t count,
+        uint32_t *values)
+    {
+        size_t first = 0, position = 0;
+
+#if defined(STREAMVBYTE_SSSE3) || defined(STREAMVBYTE_NEON)
+        // the shuffle leaves the values in host order, which is only the wire order on little endian hosts
+        const uint32_t probe = 1;
+
+        unsigned char lowest;
+
+        std::memcpy(&lowest, &probe, 1);
+
+#if defined(STREAMVBYTE_SSSE3)
+        const auto vectorized = lowest == 1 && has_ssse3();
+#else
+        const auto vectorized = lowest == 1;
+#endif
+
+        if (vectorized)
+        {
+            // the kernel stops early once too few data bytes remain for a full load, the rest are decoded below
+            first = decode_blocks(control, data, length, count / 4, values, position) * 4;
+        }
+#else
+        (void)length;
+#endif
+
+        return position + decode_scalar(control, data + position, first, count, values);
+    }
+
+    size_t encode(const uint32_t *values, size_t count, unsigned char *control, unsigned char *data)
+    {
+        std::memset(control, 0, control_size(count));
+
+        size_t position = 0;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const auto value = values[i];
+
+            const auto code = length_code(value);
+
+            control[i / 4] |= uint8_t(code << ((i % 4) * 2));
+
+            for (size_t byte = 0; byte <= code; ++byte)
+            {
+                data[position + byte] = uint8_t(value >> (byte * 8));
+            }
+
+            position += code + 1;
+        }
+
+        return position;
+    }
+} // namespace Serialization::StreamVByte
@@ -0,0 +1,1263 @@
+// Copyright (c) 2020-2024, Brandon Lehmann
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <serialization.h>
+#include <sstream>
+
+/**
+ * Runs the function the given number of times and reports the time per iteration and,
+ * if the number of bytes processed per iteration is supplied, the throughput
+ */
+static inline void benchmark(const std::string &name, size_t iterations, size_t bytes, const std::function<void()> &func)
+{
+    // warm up the caches and branch predictors
+    func();
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        func();
+    }
+
+    const auto elapsed =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    const auto per_iteration = double(elapsed) / double(iterations);
+
+    std::cout << std::left << std::setw(50) << name << std::right << std::setw(14) << std::fixed
+              << std::setprecision(1) << per_iteration << " ns/op";
+
+    if (bytes != 0)
+    {
+        std::cout << std::setw(12) << std::setprecision(2) << (double(bytes) / per_iteration) << " GB/s";
+    }
+
+    std::cout << std::endl;
+}
+
+static volatile unsigned char sink;
+
+static void benchmark_secure_erase()
+{
+    std::cout << std::endl << "secure_erase()" << std::endl;
+
+    for (const auto &size : {size_t(32), size_t(4096), size_t(1 << 20), size_t(16 << 20)})
+    {
+        auto buffer = std::vector<unsigned char>(size, 0xff);
+
+        const auto iterations = std::max(size_t(16), (size_t(1) << 30) / size / 4);
+
+        benchmark(
+            "secure_erase " + std::to_string(size) + " bytes",
+            iterations,
+            size,
+            [&]() { secure_erase(buffer.data(), buffer.size()); });
+
+        benchmark(
+            "memset " + std::to_string(size) + " bytes",
+            iterations,
+            size,
+            [&]()
+            {
+                std::memset(buffer.data(), 0, buffer.size());
+
+                // read back through a volatile so the plain memset cannot be elided
+                sink = *static_cast<volatile unsigned char *>(buffer.data());
+            });
+    }
+}
+
+static void benchmark_delta_varint()
+{
+    std::cout << std::endl << "delta_varint() vs. varint()" << std::endl;
+
+    const size_t count = 1 << 16;
+
+    std::vector<uint64_t> heights, timestamps;
+
+    uint64_t state = 0x9e3779b97f4a7c15;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        state ^= state << 13;
+
+        state ^= state >> 7;
+
+        state ^= state << 17;
+
+        heights.push_back(3000000 + i);
+
+        // block timestamps: roughly two minutes apart with jitter
+        timestamps.push_back((timestamps.empty() ? 1700000000 : timestamps.back()) + 60 + state % 120);
+    }
+
+    for (const auto &[name, values] : {std::make_pair("heights", heights), std::make_pair("timestamps", timestamps)})
+    {
+        Serialization::serializer_t plain, delta;
+
+        plain.varint(values);
+
+        delta.delta_varint(values);
+
+        std::cout << name << ": varint " << plain.size() << " bytes, delta_varint " << delta.size() << " bytes"
+                  << std::endl;
+
+        const auto plain_bytes = plain.vector(), delta_bytes = delta.vector();
+
+        std::vector<uint64_t> output;
+
+        benchmark(
+            std::string("varintV ") + name,
+            200,
+            count * sizeof(uint64_t),
+            [&]()
+            {
+                Serialization::deserializer_t reader(plain_bytes);
+
+                reader.varintV(output);
+            });
+
+        benchmark(
+            std::string("delta_varintV ") + name,
+            200,
+            count * sizeof(uint64_t),
+            [&]()
+            {
+                Serialization::deserializer_t reader(delta_bytes);
+
+                reader.delta_varintV(output);
+            });
+    }
+}
+
+static void benchmark_bitpacked()
+{
+    std::cout << std::endl << "bitpacked() vs. varint()" << std::endl;
+
+    const size_t count = 1 << 16;
+
+    uint64_t state = 0x2545f4914f6cdd1d;
+
+    for (const auto &bits : {4, 12, 20})
+    {
+        std::vector<uint32_t> values(count);
+
+        for (auto &value : values)
+        {
+            state ^= state << 13;
+
+            state ^= state >> 7;
+
+            state ^= state << 17;
+
+            value = uint32_t(state & ((uint64_t(1) << bits) - 1));
+        }
+
+        Serialization::serializer_t plain, packed;
+
+        plain.varint(values);
+
+        packed.bitpacked(values);
+
+        std::cout << bits << "-bit values: raw " << count * sizeof(uint32_t) << " bytes, varint " << plain.size()
+                  << " bytes, bitpacked " << packed.size() << " bytes" << std::endl;
+
+        const auto plain_bytes = plain.vector(), packed_bytes = packed.vector();
+
+        std::vector<uint32_t> output;
+
+        benchmark(
+            "varintV " + std::to_string(bits) + "-bit",
+            200,
+            count * sizeof(uint32_t),
+            [&]()
+            {
+                Serialization::deserializer_t reader(plain_bytes);
+
+                reader.varintV(output);
+            });
+
+        benchmark(
+            "bitpackedV " + std::to_string(bits) + "-bit",
+            200,
+            count * sizeof(uint32_t),
+            [&]()
+            {
+                Serialization::deserializer_t reader(packed_bytes);
+
+                reader.bitpackedV(output);
+            });
+
+        benchmark(
+            "bitpacked " + std::to_string(bits) + "-bit",
+            200,
+            count * sizeof(uint32_t),
+            [&]()
+            {
+                Serialization::serializer_t writer;
+
+                writer.bitpacked(values);
+            });
+    }
+}
+
+static void benchmark_streamvbyte()
+{
+    std::cout << std::endl << "streamvbyte() vs. varint()" << std::endl;
+
+    const size_t count = 1 << 16;
+
+    uint64_t state = 0x5851f42d4c957f2d;
+
+    for (const auto &bits : {7, 16, 32})
+    {
+        std::vector<uint32_t> values(count);
+
+        for (auto &value : values)
+        {
+            state ^= state << 13;
+
+            state ^= state >> 7;
+
+            state ^= state << 17;
+
+            // values of mixed lengths up to the given width
+            value = uint32_t(state >> (64 - bits)) >> (state % bits);
+        }
+
+        Serialization::serializer_t plain, stream;
+
+        plain.varint(values);
+
+        stream.streamvbyte(values);
+
+        std::cout << "up to " << bits << "-bit values: varint " << plain.size() << " bytes, streamvbyte "
+                  << stream.size() << " bytes" << std::endl;
+
+        const auto plain_bytes = plain.vector(), stream_bytes = stream.vector();
+
+        std::vector<uint32_t> output;
+
+        benchmark(
+            "varintV " + std::to_string(bits) + "-bit",
+            200,
+            count * sizeof(uint32_t),
+            [&]()
+            {
+                Serialization::deserializer_t reader(plain_bytes);
+
+                reader.varintV(output);
+            });
+
+        benchmark(
+            "streamvbyteV " + std::to_string(bits) + "-bit",
+            200,
+            count * sizeof(uint32_t),
+            [&]()
+            {
+                Serialization::deserializer_t reader(stream_bytes);
+
+                reader.streamvbyteV(output);
+            });
+    }
+}
+
+static void benchmark_wide_varint()
+{
+    std::cout << std::endl << "varint() of wide types" << std::endl;
+
+    const size_t count = 1 << 16;
+
+    std::vector<uint128_t> amounts;
+
+    std::vector<uint256_t> wide_amounts;
+
+    uint64_t state = 0x2545f4914f6cdd1d;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        state ^= state << 13;
+
+        state ^= state >> 7;
+
+        state ^= state << 17;
+
+        // amounts are overwhelmingly small values held in wide types
+        amounts.push_back(state % 100000000000);
+
+        wide_amounts.push_back(uint256_t(amounts.back()));
+    }
+
+    Serialization::serializer_t narrow, wide;
+
+    narrow.varint(amounts);
+
+    wide.varint(wide_amounts);
+
+    std::cout << "uint128_t amounts: raw " << count * 16 << " bytes, varint " << narrow.size() << " bytes"
+              << std::endl;
+
+    const auto narrow_bytes = narrow.vector(), wide_bytes = wide.vector();
+
+    benchmark(
+        "varint uint128_t",
+        200,
+        count * 16,
+        [&]()
+        {
+            Serialization::serializer_t writer;
+
+            writer.varint(amounts);
+        });
+
+    benchmark(
+        "varintV uint128_t",
+        200,
+        count * 16,
+        [&]()
+        {
+            Serialization::deserializer_t reader(narrow_bytes);
+
+            reader.varintV<uint128_t>();
+        });
+
+    benchmark(
+        "varintV uint256_t",
+        200,
+        count * 32,
+        [&]()
+        {
+            Serialization::deserializer_t reader(wide_bytes);
+
+            reader.varintV<uint256_t>();
+        });
+}
+
+static void benchmark_wide_fixed()
+{
+    std::cout << std::endl << "uint128() / uint256()" << std::endl;
+
+    const size_t count = 1 << 14;
+
+    const auto value = uint256_t(uint128_t(0x1111111111111111, 0x2222222222222222), uint128_t(3, 4));
+
+    for (const auto &big_endian : {false, true})
+    {
+        const std::string order = big_endian ? " big endian" : " little endian";
+
+        benchmark(
+            "memcpy and reverse uint256" + order,
+            200,
+            count * 32,
+            [&]()
+            {
+                Serialization::serializer_t writer;
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    // the previous implementation: copy out the object representation and reverse it
+                    std::vector<unsigned char> bytes(sizeof(value));
+
+                    std::memcpy(bytes.data(), &value, sizeof(value));
+
+                    if (big_endian)
+                    {
+                        std::reverse(bytes.begin(), bytes.end());
+                    }
+
+                    writer.bytes(bytes);
+                }
+            });
+
+        Serialization::serializer_t writer;
+
+        benchmark(
+            "uint256" + order,
+            200,
+            count * 32,
+            [&]()
+            {
+                writer.reset();
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    writer.uint256(value, big_endian);
+                }
+            });
+
+        const auto bytes = writer.vector();
+
+        benchmark(
+            "deserializer_t::uint256" + order,
+            200,
+            count * 32,
+            [&]()
+            {
+                Serialization::deserializer_t reader(bytes);
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    reader.uint256(false, big_endian);
+                }
+            });
+    }
+}
+
+static void benchmark_fixed_arrays()
+{
+    std::cout << std::endl << "uint64() arrays" << std::endl;
+
+    const size_t count = 1 << 16;
+
+    std::vector<uint64_t> values(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        values[i] = i * 0x9e3779b97f4a7c15;
+    }
+
+    for (const auto &big_endian : {false, true})
+    {
+        const std::string order = big_endian ? " big endian" : " little endian";
+
+        benchmark(
+            "uint64 loop" + order,
+            200,
+            count * sizeof(uint64_t),
+            [&]()
+            {
+                Serialization::serializer_t writer;
+
+                for (const auto &value : values)
+                {
+                    writer.uint64(value, big_endian);
+                }
+            });
+
+        Serialization::serializer_t writer;
+
+        benchmark(
+            "uint64 array" + order,
+            200,
+            count * sizeof(uint64_t),
+            [&]()
+            {
+                writer.reset();
+
+                writer.uint64(values, big_endian);
+            });
+
+        const auto bytes = writer.vector();
+
+        std::vector<uint64_t> output;
+
+        benchmark(
+            "uint64V" + order,
+            200,
+            count * sizeof(uint64_t),
+            [&]()
+            {
+                Serialization::deserializer_t reader(bytes);
+
+                reader.uint64V(output, false, big_endian);
+            });
+    }
+}
+
+static void benchmark_bit_stream()
+{
+    std::cout << std::endl << "bit_writer_t vs. boolean()" << std::endl;
+
+    // records of twelve flags, a 3-bit enum and a 5-bit enum
+    const size_t count = 1 << 14;
+
+    std::vector<uint32_t> records(count);
+
+    uint64_t state = 0x2545f4914f6cdd1d;
+
+    for (auto &record : records)
+    {
+        state ^= state << 13;
+
+        state ^= state >> 7;
+
+        state ^= state << 17;
+
+        record = uint32_t(state & 0xfffff);
+    }
+
+    Serialization::serializer_t bytes, bits;
+
+    benchmark(
+        "boolean + uint8 records",
+        200,
+        0,
+        [&]()
+        {
+            bytes.reset();
+
+            for (const auto &record : records)
+            {
+                for (size_t i = 0; i < 12; ++i)
+                {
+                    bytes.boolean((record >> i) & 1);
+                }
+
+                bytes.uint8(uint8_t((record >> 12) & 0x7));
+
+                bytes.uint8(uint8_t(record >> 15));
+            }
+        });
+
+    benchmark(
+        "bit_writer_t records",
+        200,
+        0,
+        [&]()
+        {
+            bits.reset();
+
+            Serialization::bit_writer_t writer(bits);
+
+            for (const auto &record : records)
+            {
+                for (size_t i = 0; i < 12; ++i)
+                {
+                    writer.flag((record >> i) & 1);
+                }
+
+                writer.bits(record >> 12, 3);
+
+                writer.bits(record >> 15, 5);
+            }
+        });
+
+    std::cout << "records: boolean + uint8 " << bytes.size() << " bytes, bit_writer_t " << bits.size() << " bytes"
+              << std::endl;
+
+    const auto byte_data = bytes.vector(), bit_data = bits.vector();
+
+    uint64_t checksum = 0;
+
+    benchmark(
+        "boolean + uint8 read",
+        200,
+        0,
+        [&]()
+        {
+            Serialization::deserializer_t reader(byte_data);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                for (size_t j = 0; j < 12; ++j)
+                {
+                    checksum += reader.boolean();
+                }
+
+                checksum += reader.uint8() + reader.uint8();
+            }
+        });
+
+    benchmark(
+        "bit_reader_t read",
+        200,
+        0,
+        [&]()
+        {
+            Serialization::deserializer_t reader(bit_data);
+
+            Serialization::bit_reader_t bits_reader(reader);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                for (size_t j = 0; j < 12; ++j)
+                {
+                    checksum += bits_reader.flag();
+                }
+
+                checksum += bits_reader.bits(3) + bits_reader.bits(5);
+            }
+        });
+
+    std::cout << "checksum: " << checksum << std::endl;
+}
+
+static void benchmark_pod_dictionary()
+{
+    std::cout << std::endl << "pod_dictionary() vs. pod()" << std::endl;
+
+    const size_t count = 1 << 14;
+
+    uint64_t state = 0x9e3779b97f4a7c15;
+
+    // high duplication: keys drawn from 64 distinct values; low duplication: every key is distinct
+    for (const auto &distinct : {size_t(64), count})
+    {
+        std::vector<SerializablePod<32>> values(count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            state ^= state << 13;
+
+            state ^= state >> 7;
+
+            state ^= state << 17;
+
+            const auto key = (distinct == count) ? i : state % distinct;
+
+            for (size_t j = 0; j < 32; ++j)
+            {
+                values[i][int(j)] = uint8_t((key * 0x9e3779b97f4a7c15) >> ((j % 8) * 8)) ^ uint8_t(j);
+            }
+        }
+
+        const auto label = std::to_string(distinct) + " distinct";
+
+        Serialization::serializer_t plain, dictionary;
+
+        plain.pod(values);
+
+        dictionary.pod_dictionary(values);
+
+        std::cout << label << ": pod " << plain.size() << " bytes, pod_dictionary " << dictionary.size() << " bytes"
+                  << std::endl;
+
+        benchmark(
+            "pod " + label,
+            50,
+            count * 32,
+            [&]()
+            {
+                Serialization::serializer_t writer;
+
+                writer.pod(values);
+            });
+
+        benchmark(
+            "pod_dictionary " + label,
+            50,
+            count * 32,
+            [&]()
+            {
+                Serialization::serializer_t writer;
+
+                writer.pod_dictionary(values);
+            });
+
+        const auto plain_bytes = plain.vector(), dictionary_bytes = dictionary.vector();
+
+        std::vector<SerializablePod<32>> output;
+
+        benchmark(
+            "podV " + label,
+            50,
+            count * 32,
+            [&]()
+            {
+                Serialization::deserializer_t reader(plain_bytes);
+
+                reader.podV(output);
+            });
+
+        benchmark(
+            "pod_dictionaryV " + label,
+            50,
+            count * 32,
+            [&]()
+            {
+                Serialization::deserializer_t reader(dictionary_bytes);
+
+                reader.pod_dictionaryV(output);
+            });
+    }
+}
+
+static void benchmark_pod_prefix()
+{
+    std::cout << std::endl << "pod_prefix() vs. pod()" << std::endl;
+
+    const size_t count = 1 << 14;
+
+    uint64_t state = 0x9e3779b97f4a7c15;
+
+    // sorted keys sharing their most significant (ie. last) 24 bytes, as in an index snapshot
+    std::vector<SerializablePod<32>> values(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        state ^= state << 13;
+
+        state ^= state >> 7;
+
+        state ^= state << 17;
+
+        for (size_t j = 0; j < 32; ++j)
+        {
+            values[i][int(j)] = (j < 8) ? uint8_t(state >> (j * 8)) : uint8_t(j);
+        }
+    }
+
+    std::sort(values.begin(), values.end());
+
+    Serialization::serializer_t plain, prefixed;
+
+    plain.pod(values);
+
+    prefixed.pod_prefix(values);
+
+    std::cout << "pod " << plain.size() << " bytes, pod_prefix " << prefixed.size() << " bytes" << std::endl;
+
+    benchmark(
+        "pod",
+        50,
+        count * 32,
+        [&]()
+        {
+            Serialization::serializer_t writer;
+
+            writer.pod(values);
+        });
+
+    benchmark(
+        "pod_prefix",
+        50,
+        count * 32,
+        [&]()
+        {
+            Serialization::serializer_t writer;
+
+            writer.pod_prefix(values);
+        });
+
+    const auto plain_bytes = plain.vector(), prefixed_bytes = prefixed.vector();
+
+    std::vector<SerializablePod<32>> output;
+
+    benchmark(
+        "podV",
+        50,
+        count * 32,
+        [&]()
+        {
+            Serialization::deserializer_t reader(plain_bytes);
+
+            reader.podV(output);
+        });
+
+    benchmark(
+        "pod_prefixV",
+        50,
+        count * 32,
+        [&]()
+        {
+            Serialization::deserializer_t reader(prefixed_bytes);
+
+            reader.pod_prefixV(output);
+        });
+
+    // a handful of lookups: decoding the whole vector to search it vs. searching the restart points
+    const size_t lookups = 64;
+
+    benchmark(
+        "podV + binary_search",
+        50,
+        lookups * 32,
+        [&]()
+        {
+            Serialization::deserializer_t reader(plain_bytes);
+
+            reader.podV(output);
+
+            for (size_t i = 0; i < lookups; ++i)
+            {
+                if (!std::binary_search(output.begin(), output.end(), values[(i * 251) % count]))
+                {
+                    exit(1);
+                }
+            }
+        });
+
+    benchmark(
+        "pod_prefix_set_t::contains",
+        50,
+        lookups * 32,
+        [&]()
+        {
+            Serialization::deserializer_t reader(prefixed_bytes);
+
+            const Serialization::pod_prefix_set_t<SerializablePod<32>> set(reader);
+
+            for (size_t i = 0; i < lookups; ++i)
+            {
+                if (!set.contains(values[(i * 251) % count]))
+                {
+                    exit(1);
+                }
+            }
+        });
+}
+
+struct benchmark_record_t
+{
+    uint32_t height;
+
+    uint16_t kind;
+
+    int32_t change;
+
+    bool spent;
+};
+
+static void benchmark_columns()
+{
+    std::cout << std::endl << "columns() vs. interleaved records" << std::endl;
+
+    const size_t count = 1 << 14;
+
+    uint64_t state = 0x9e3779b97f4a7c15;
+
+    std::vector<benchmark_record_t> records(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        state ^= state << 13;
+
+        state ^= state >> 7;
+
+        state ^= state << 17;
+
+        records[i] = {uint32_t(3000000 + i / 4), uint16_t(state % 12), int32_t(state >> 40) % 5000, (state & 1) != 0};
+    }
+
+    const auto write_rows = [&](Serialization::serializer_t &writer)
+    {
+        writer.varint(records.size());
+
+        for (const auto &record : records)
+        {
+            writer.varint(record.height);
+
+            writer.varint(record.kind);
+
+            writer.svarint(record.change);
+
+            writer.boolean(record.spent);
+        }
+    };
+
+    const auto write_columns = [&](Serialization::serializer_t &writer)
+    {
+        writer.columns(
+            records,
+            &benchmark_record_t::height,
+            &benchmark_record_t::kind,
+            &benchmark_record_t::change,
+            &benchmark_record_t::spent);
+    };
+
+    Serialization::serializer_t rows, columns;
+
+    write_rows(rows);
+
+    write_columns(columns);
+
+    std::cout << "interleaved " << rows.size() << " bytes, columns " << columns.size() << " bytes" << std::endl;
+
+    benchmark(
+        "interleaved records",
+        50,
+        count * sizeof(benchmark_record_t),
+        [&]()
+        {
+            Serialization::serializer_t writer;
+
+            write_rows(writer);
+        });
+
+    benchmark(
+        "columns",
+        50,
+        count * sizeof(benchmark_record_t),
+        [&]()
+        {
+            Serialization::serializer_t writer;
+
+            write_columns(writer);
+        });
+
+    const auto row_bytes = rows.vector(), column_bytes = columns.vector();
+
+    std::vector<benchmark_record_t> output;
+
+    benchmark(
+        "interleaved records read",
+        50,
+        count * sizeof(benchmark_record_t),
+        [&]()
+        {
+            Serialization::deserializer_t reader(row_bytes);
+
+            output.resize(reader.varint<size_t>());
+
+            for (auto &record : output)
+            {
+                record.height = reader.varint<uint32_t>();
+
+                record.kind = reader.varint<uint16_t>();
+
+                record.change = reader.svarint<int32_t>();
+
+                record.spent = reader.boolean();
+            }
+        });
+
+    benchmark(
+        "column_reader_t::records",
+        50,
+        count * sizeof(benchmark_record_t),
+        [&]()
+        {
+            Serialization::deserializer_t reader(column_bytes);
+
+            const Serialization::column_reader_t columns(reader);
+
+            columns.records(
+                output,
+                &benchmark_record_t::height,
+                &benchmark_record_t::kind,
+                &benchmark_record_t::change,
+                &benchmark_record_t::spent);
+        });
+
+    std::vector<uint32_t> heights;
+
+    benchmark(
+        "column_reader_t::column (height only)",
+        50,
+        count * sizeof(uint32_t),
+        [&]()
+        {
+            Serialization::deserializer_t reader(column_bytes);
+
+            const Serialization::column_reader_t columns(reader);
+
+            columns.column(0, heights);
+        });
+}
+
+static void benchmark_compression()
+{
+    std::cout << std::endl << "compressed() / decompressor_t" << std::endl;
+
+    uint64_t state = 0x9e3779b97f4a7c15;
+
+    // a block-like payload: small varints, fixed width amounts, and keys that recur across records
+    std::vector<SerializablePod<32>> keys(256);
+
+    for (auto &key : keys)
+    {
+        for (size_t j = 0; j < 32; ++j)
+        {
+            state ^= state << 13;
+
+            state ^= state >> 7;
+
+            state ^= state << 17;
+
+            key[int(j)] = uint8_t(state);
+        }
+    }
+
+    Serialization::serializer_t payload;
+
+    for (size_t i = 0; i < (1 << 15); ++i)
+    {
+        state ^= state << 13;
+
+        state ^= state >> 7;
+
+        state ^= state << 17;
+
+        payload.varint(i);
+
+        payload.pod(keys[state % keys.size()]);
+
+        payload.uint64(state % 1000000);
+
+        payload.uint32(0);
+    }
+
+    const auto compressed = payload.compressed();
+
+    std::cout << "payload " << payload.size() << " bytes, compressed " << compressed.size() << " bytes (ratio "
+              << std::setprecision(2) << double(payload.size()) / double(compressed.size()) << ")" << std::endl;
+
+    benchmark("compressed", 20, payload.size(), [&]() { const auto result = payload.compressed(); });
+
+    benchmark(
+        "decompressor_t",
+        20,
+        payload.size(),
+        [&]()
+        {
+            Serialization::rope_deserializer_t reader {std::vector<std::vector<unsigned char>>()};
+
+            Serialization::decompressor_t decompressor(reader);
+
+            decompressor.write(compressed);
+        });
+
+    // the codec alone on a single chunk
+    const auto chunk = payload.vector();
+
+    std::vector<unsigned char> block(Serialization::Compression::bound(COMPRESSION_CHUNK_SIZE)),
+        output(COMPRESSION_CHUNK_SIZE);
+
+    const auto stored = Serialization::Compression::compress(chunk.data(), COMPRESSION_CHUNK_SIZE, block.data());
+
+    benchmark(
+        "Compression::compress",
+        200,
+        COMPRESSION_CHUNK_SIZE,
+        [&]() { Serialization::Compression::compress(chunk.data(), COMPRESSION_CHUNK_SIZE, block.data()); });
+
+    benchmark(
+        "Compression::decompress",
+        200,
+        COMPRESSION_CHUNK_SIZE,
+        [&]()
+        { Serialization::Compression::decompress(block.data(), stored, output.data(), COMPRESSION_CHUNK_SIZE); });
+}
+
+static void benchmark_pod_sparse()
+{
+    std::cout << std::endl << "pod_sparse() vs. pod()" << std::endl;
+
+    const size_t count = 1 << 14;
+
+    uint64_t state = 0x9e3779b97f4a7c15;
+
+    // percentages of unset, padded (a few non-zero bytes) and fully populated fields
+    for (const auto &[unset, padded] : {std::pair<size_t, size_t>(0, 0), {50, 30}, {90, 5}})
+    {
+        std::vector<SerializablePod<32>> values(count);
+
+        for (auto &value : values)
+        {
+            state ^= state << 13;
+
+            state ^= state >> 7;
+
+            state ^= state << 17;
+
+            const auto kind = state % 100;
+
+            for (size_t j = 0; j < 32; ++j)
+            {
+                if (kind >= unset + padded || (kind >= unset && j < 4))
+                {
+                    value[int(j)] = uint8_t((state >> ((j % 8) * 8)) | 1);
+                }
+            }
+        }
+
+        const auto label = std::to_string(unset) + "% unset, " + std::to_string(padded) + "% padded";
+
+        Serialization::serializer_t plain, sparse;
+
+        plain.pod(values);
+
+        sparse.pod_sparse(values);
+
+        std::cout << label << ": pod " << plain.size() << " bytes, pod_sparse " << sparse.size() << " bytes"
+                  << std::endl;
+
+        benchmark(
+            "pod " + label,
+            50,
+            count * 32,
+            [&]()
+            {
+                Serialization::serializer_t writer;
+
+                writer.pod(values);
+            });
+
+        benchmark(
+            "pod_sparse " + label,
+            50,
+            count * 32,
+            [&]()
+            {
+                Serialization::serializer_t writer;
+
+                writer.pod_sparse(values);
+            });
+
+        const auto plain_bytes = plain.vector(), sparse_bytes = sparse.vector();
+
+        std::vector<SerializablePod<32>> output;
+
+        benchmark(
+            "podV " + label,
+            50,
+            count * 32,
+            [&]()
+            {
+                Serialization::deserializer_t reader(plain_bytes);
+
+                reader.podV(output);
+            });
+
+        benchmark(
+            "pod_sparseV " + label,
+            50,
+            count * 32,
+            [&]()
+            {
+                Serialization::deserializer_t reader(sparse_bytes);
+
+                reader.pod_sparseV(output);
+            });
+    }
+}
+
+static void benchmark_record_stream()
+{
+    std::cout << std::endl << "record_stream_reader_t" << std::endl;
+
+    const size_t count = 200000;
+
+    std::stringstream file(std::ios::in | std::ios::out | std::ios::binary);
+
+    Serialization::serializer_t record;
+
+    benchmark(
+        "record_stream_writer_t::append",
+        5,
+        0,
+        [&]()
+        {
+            file.str({});
+
+            Serialization::record_stream_writer_t writer(file);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                record.reset();
+
+                record.varint(i);
+
+                record.uint64(i * 0x9e3779b97f4a7c15);
+
+                writer.append(record);
+            }
+        });
+
+    std::cout << count << " records, " << file.str().size() << " bytes" << std::endl;
+
+    Serialization::record_stream_reader_t reader(file);
+
+    Serialization::deserializer_t output({});
+
+    benchmark(
+        "sequential read",
+        5,
+        0,
+        [&]()
+        {
+            reader.seek(0);
+
+            while (reader.next(output))
+            {
+            }
+        });
+
+    // reaching a record near the end: reading every record before it vs. seeking via the index
+    const auto target = count - 1000;
+
+    benchmark(
+        "read to record N",
+        5,
+        0,
+        [&]()
+        {
+            reader.seek(0);
+
+            for (size_t i = 0; i <= target; ++i)
+            {
+                reader.next(output);
+            }
+        });
+
+    benchmark(
+        "seek to record N",
+        5,
+        0,
+        [&]()
+        {
+            reader.seek(target);
+
+            reader.next(output);
+        });
+}
+
+int main()
+{
+    benchmark_secure_erase();
+
+    benchmark_delta_varint();
+
+    benchmark_bitpacked();
+
+    benchmark_streamvbyte();
+
+    benchmark_wide_varint();
+
+    benchmark_wide_fixed();
+
+    benchmark_fixed_arrays();
+
+    benchmark_bit_stream();
+
+    benchmark_pod_dictionary();
+
+    benchmark_pod_prefix();
+
+    benchmark_columns();
+
+    benchmark_compression();
+
+    benchmark_pod_sparse();
+
+    benchmark_record_stream();
+}
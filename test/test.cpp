@@ -24,12 +24,24 @@
 // STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
 // THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
-#include <serialization.h>
 #include <limits>
+#include <memory_resource>
+#include <optional>
+#include <serialization.h>
+#include <sstream>
 
 typedef SerializablePod<32> value_t;
 
+struct element_t : value_t
+{
+    element_t() = default;
+
+    JSON_STRING_CONSTRUCTOR(element_t, fromJSON)
+};
+
 const auto input = std::string("974506601a60dc465e6e9acddb563889e63471849ec4198656550354b8541fcb");
 
 template<typename T> static inline void test_varint(const T value, const std::string &name) {
@@ -139,4 +151,1824 @@ int main()
     test_varint_range<uint32_t>("uint32_t");
 
     test_varint_range<uint64_t>("uint64_t");
+
+    {
+        std::cout << std::endl << "Testing nested length prefix backpatching" << std::endl;
+
+        for (const auto &length : {size_t(0), size_t(100), size_t(300), size_t(70000)})
+        {
+            const auto body = std::vector<unsigned char>(length, 0xab);
+
+            auto expected = Serialization::serializer_t();
+
+            expected.uint8(1);
+
+            expected.varint(body.size());
+
+            expected.bytes(body);
+
+            expected.uint8(2);
+
+            auto writer = Serialization::serializer_t();
+
+            writer.uint8(1);
+
+            writer.begin_nested();
+
+            writer.bytes(body);
+
+            writer.end_nested();
+
+            writer.uint8(2);
+
+            if (writer.vector() != expected.vector())
+            {
+                std::cout << "nested varint prefix MISMATCH at length " << length << "!!" << std::endl;
+
+                exit(1);
+            }
+        }
+
+        auto writer = Serialization::serializer_t();
+
+        writer.begin_nested(true);
+
+        writer.begin_nested();
+
+        writer.bytes(std::vector<unsigned char>(200, 0xcd));
+
+        writer.end_nested();
+
+        writer.end_nested();
+
+        auto reader = Serialization::deserializer_t(writer);
+
+        if (reader.uint32() != 202 || reader.varint<uint64_t>() != 200)
+        {
+            std::cout << "nested fixed width prefix MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+
+        std::cout << "nested length prefix backpatching passed!" << std::endl;
+    }
+
+    {
+        std::cout << std::endl << "Testing deserializer_t slices" << std::endl;
+
+        auto writer = Serialization::serializer_t();
+
+        writer.uint8(0xff);
+
+        writer.begin_nested();
+
+        writer.uint32(12345);
+
+        writer.pod(value);
+
+        writer.end_nested();
+
+        writer.uint8(0xee);
+
+        auto reader = Serialization::deserializer_t(writer);
+
+        reader.skip();
+
+        auto child = reader.slice(reader.varint<uint64_t>(), true);
+
+        if (child.data() != reader.data() + 2 || child.size() != 36 || child.uint32() != 12345
+            || child.pod<value_t>() != value || child.unread_bytes() != 0)
+        {
+            std::cout << "slice MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+
+        try
+        {
+            child.uint8();
+
+            std::cout << "slice read past its bounds!!" << std::endl;
+
+            exit(1);
+        }
+        catch (const std::range_error &e)
+        {
+            std::cout << "Expected error: " << e.what() << std::endl;
+        }
+
+        reader.slice(36);
+
+        if (reader.uint8() != 0xee)
+        {
+            std::cout << "slice did not advance the parent!!" << std::endl;
+
+            exit(1);
+        }
+
+        std::cout << "deserializer_t slices passed!" << std::endl;
+    }
+
+    {
+        std::cout << std::endl << "Testing shared deserializer_t copies" << std::endl;
+
+        auto writer = Serialization::serializer_t();
+
+        writer.uint64(1);
+
+        writer.uint64(2);
+
+        const auto reader = Serialization::deserializer_t(writer.vector());
+
+        auto first = reader, second = reader;
+
+        first.skip(sizeof(uint64_t));
+
+        if (first.data() != reader.data() || second.data() != reader.data() || first.uint64() != 2
+            || second.uint64() != 1)
+        {
+            std::cout << "shared deserializer_t MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+
+        std::cout << "shared deserializer_t copies passed!" << std::endl;
+    }
+
+    {
+        std::cout << std::endl << "Testing deserializer_t reuse" << std::endl;
+
+        auto writer = Serialization::serializer_t();
+
+        writer.pod(std::vector<value_t>(4, value));
+
+        writer.varint(std::vector<uint64_t>({1, 300, 70000}));
+
+        auto reader = Serialization::deserializer_t(writer);
+
+        const auto storage = reader.data();
+
+        auto pods = std::vector<value_t>(8);
+
+        const auto pods_storage = pods.data();
+
+        auto varints = std::vector<uint64_t>();
+
+        for (size_t i = 0; i < 2; ++i)
+        {
+            reader.assign(writer.vector());
+
+            reader.podV(pods);
+
+            reader.varintV(varints);
+
+            if (reader.data() != storage || pods.data() != pods_storage || pods.size() != 4 || pods[3] != value
+                || varints != std::vector<uint64_t>({1, 300, 70000}))
+            {
+                std::cout << "deserializer_t reuse MISMATCH!!" << std::endl;
+
+                exit(1);
+            }
+        }
+
+        std::cout << "deserializer_t reuse passed!" << std::endl;
+    }
+
+    {
+        std::cout << std::endl << "Testing serializer_t gather mode" << std::endl;
+
+        const auto blob = std::vector<unsigned char>(4096, 0x5a);
+
+        auto expected = Serialization::serializer_t(), writer = Serialization::serializer_t();
+
+        writer.gather_threshold(1024);
+
+        for (auto *output : {&expected, &writer})
+        {
+            output->uint32(7);
+
+            output->begin_nested();
+
+            output->bytes(blob);
+
+            output->uint8(1);
+
+            output->end_nested();
+
+            output->bytes(blob);
+        }
+
+        const auto segments = writer.segments();
+
+        if (writer.vector() != expected.vector() || writer.size() != expected.size() || segments.size() != 4
+            || segments[1].data != blob.data() || segments[3].data != blob.data())
+        {
+            std::cout << "serializer_t gather mode MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+
+        std::cout << "serializer_t gather mode passed!" << std::endl;
+    }
+
+    {
+        std::cout << std::endl << "Testing rope_deserializer_t" << std::endl;
+
+        auto writer = Serialization::serializer_t();
+
+        writer.uint8(9);
+
+        writer.uint16(0x1234, true);
+
+        writer.uint64(0x0102030405060708);
+
+        writer.varint<uint64_t>(std::numeric_limits<uint64_t>::max());
+
+        writer.pod(std::vector<value_t>(3, value));
+
+        writer.varint(std::vector<uint32_t>({1, 200, 300000}));
+
+        const auto data = writer.vector();
+
+        for (const auto &chunk_size : {size_t(1), size_t(3), size_t(7), data.size()})
+        {
+            std::vector<std::vector<unsigned char>> chunks;
+
+            for (size_t i = 0; i < data.size(); i += chunk_size)
+            {
+                chunks.emplace_back(data.begin() + i, data.begin() + std::min(i + chunk_size, data.size()));
+            }
+
+            auto reader = Serialization::rope_deserializer_t(std::move(chunks));
+
+            if (reader.uint8() != 9 || reader.uint16(false, true) != 0x1234 || reader.uint64() != 0x0102030405060708
+                || reader.varint<uint64_t>() != std::numeric_limits<uint64_t>::max()
+                || reader.podV<value_t>() != std::vector<value_t>(3, value)
+                || reader.varintV<uint32_t>() != std::vector<uint32_t>({1, 200, 300000}) || reader.unread_bytes() != 0)
+            {
+                std::cout << "rope_deserializer_t MISMATCH with chunk size " << chunk_size << "!!" << std::endl;
+
+                exit(1);
+            }
+        }
+
+        // a copy must remain readable, from the same position, after the original is destroyed
+        std::optional<Serialization::rope_deserializer_t> original;
+
+        original.emplace(std::vector<std::vector<unsigned char>> {{0x01, 0x02}, {0x03}});
+
+        original->uint8();
+
+        auto copy = *original;
+
+        Serialization::rope_deserializer_t assigned {std::vector<std::vector<unsigned char>>()};
+
+        assigned = *original;
+
+        original.reset();
+
+        if (copy.uint8() != 0x02 || copy.uint8() != 0x03 || assigned.uint16() != 0x0302)
+        {
+            std::cout << "rope_deserializer_t copy MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+
+        std::cout << "rope_deserializer_t passed!" << std::endl;
+    }
+
+    {
+        std::cout << std::endl << "Testing serializer_t buffer pooling" << std::endl;
+
+        Serialization::BufferPool::enable();
+
+        Serialization::BufferPool::reset_stats();
+
+        for (size_t i = 0; i < 100; ++i)
+        {
+            auto writer = Serialization::serializer_t();
+
+            writer.bytes(std::vector<unsigned char>(1000, 0x01));
+        }
+
+        const auto stats = Serialization::BufferPool::stats();
+
+        Serialization::BufferPool::enable(false);
+
+        std::cout << "Hit rate: " << stats.hit_rate() << " Retained bytes: " << stats.retained_bytes << std::endl;
+
+        if (stats.hits != 99 || stats.misses != 1 || stats.retained_buffers != 1 || stats.retained_bytes < 1000)
+        {
+            std::cout << "serializer_t buffer pooling MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+
+        std::cout << "serializer_t buffer pooling passed!" << std::endl;
+    }
+
+    {
+        std::cout << std::endl << "Testing memory resource support" << std::endl;
+
+        unsigned char arena_memory[16384];
+
+        std::pmr::monotonic_buffer_resource arena(arena_memory, sizeof(arena_memory), std::pmr::null_memory_resource());
+
+        const auto in_arena = [&](const void *pointer)
+        {
+            return pointer >= arena_memory && pointer < arena_memory + sizeof(arena_memory);
+        };
+
+        auto writer = Serialization::serializer_t(&arena);
+
+        writer.pod(std::vector<value_t>(4, value));
+
+        writer.varint(std::vector<uint64_t>({5, 6, 7}));
+
+        auto reader = Serialization::deserializer_t(writer, &arena);
+
+        auto pods = SerializableVector<element_t, std::pmr::polymorphic_allocator<element_t>>(&arena);
+
+        pods.deserialize(reader);
+
+        std::pmr::vector<uint64_t> varints(&arena);
+
+        reader.varintV(varints);
+
+        if (!in_arena(writer.data()) || !in_arena(reader.data()) || !in_arena(pods.container.data())
+            || !in_arena(varints.data()) || pods.size() != 4 || pods[3] != value || varints.back() != 7
+            || pods.to_string() != writer.to_string().substr(0, pods.to_string().size()))
+        {
+            std::cout << "memory resource MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+
+        std::cout << "memory resource support passed!" << std::endl;
+    }
+
+    {
+        std::cout << std::endl << "Testing secure arena" << std::endl;
+
+        static unsigned char upstream_memory[65536];
+
+        // the upstream never reuses memory, so what the arena leaves behind can be inspected afterwards
+        std::pmr::monotonic_buffer_resource upstream(
+            upstream_memory, sizeof(upstream_memory), std::pmr::null_memory_resource());
+
+        {
+            auto arena = Serialization::secure_arena_t(256, &upstream);
+
+            const auto scope = Serialization::secure_arena_t::scope_t(arena);
+
+            std::pmr::vector<value_t> secrets(&arena);
+
+            for (size_t i = 0; i < 500; ++i)
+            {
+                secrets.push_back(value);
+            }
+
+            if (!arena.contains(secrets.data()) || !Serialization::secure_arena_t::covers(&secrets.back()))
+            {
+                std::cout << "secure arena MISMATCH!!" << std::endl;
+
+                exit(1);
+            }
+        }
+
+        for (const auto &byte : upstream_memory)
+        {
+            if (byte != 0)
+            {
+                std::cout << "secure arena left secret data behind!!" << std::endl;
+
+                exit(1);
+            }
+        }
+
+        std::cout << "secure arena passed!" << std::endl;
+    }
+
+    {
+        std::cout << std::endl << "Testing secure buffers" << std::endl;
+
+        static unsigned char upstream_memory[65536];
+
+        std::pmr::monotonic_buffer_resource upstream(
+            upstream_memory, sizeof(upstream_memory), std::pmr::null_memory_resource());
+
+        auto resource = Serialization::secure_resource_t(true, &upstream);
+
+        {
+            auto writer = Serialization::serializer_t(&resource);
+
+            writer.pod(value);
+
+            // secure buffers grow in large steps rather than reallocating (and wiping) as they fill
+            const auto *const first = writer.data();
+
+            for (size_t i = 1; i < 100; ++i)
+            {
+                writer.pod(value);
+            }
+
+            if (writer.data() != first)
+            {
+                std::cout << "secure buffers reallocated MISMATCH!!" << std::endl;
+
+                exit(1);
+            }
+
+            auto reader = Serialization::deserializer_t(writer, &resource);
+
+            if (reader.pod<value_t>() != value)
+            {
+                std::cout << "secure buffers MISMATCH!!" << std::endl;
+
+                exit(1);
+            }
+
+            writer.secure_reset();
+
+            if (writer.size() != 0 || *writer.data() != 0)
+            {
+                std::cout << "secure_reset() left secret data behind!!" << std::endl;
+
+                exit(1);
+            }
+        }
+
+        for (const auto &byte : upstream_memory)
+        {
+            if (byte != 0)
+            {
+                std::cout << "secure buffers left secret data behind!!" << std::endl;
+
+                exit(1);
+            }
+        }
+
+#ifdef __linux__
+        // locks do not nest, so freeing one buffer must not unlock a page another live buffer still uses
+        {
+            const auto locked_kb = []()
+            {
+                std::ifstream status("/proc/self/status");
+
+                std::string line;
+
+                while (std::getline(status, line))
+                {
+                    if (line.rfind("VmLck:", 0) == 0)
+                    {
+                        return std::stoul(line.substr(6));
+                    }
+                }
+
+                return 0UL;
+            };
+
+            // both buffers come from the same page of the upstream memory
+            alignas(4096) static unsigned char page_memory[4096];
+
+            std::pmr::monotonic_buffer_resource pages(
+                page_memory, sizeof(page_memory), std::pmr::null_memory_resource());
+
+            auto locking = Serialization::secure_resource_t(true, &pages);
+
+            auto *first = locking.allocate(64, 64), *second = locking.allocate(64, 64);
+
+            const auto before = locked_kb();
+
+            locking.deallocate(first, 64, 64);
+
+            if (locking.lock_failures() == 0 && before != 0 && locked_kb() != before)
+            {
+                std::cout << "secure buffers unlocked a page still in use!!" << std::endl;
+
+                exit(1);
+            }
+
+            // nor may another instance, as page locks belong to the process rather than to the resource
+            auto other = Serialization::secure_resource_t(true, &pages);
+
+            other.deallocate(other.allocate(64, 64), 64, 64);
+
+            if (other.lock_failures() == 0 && before != 0 && locked_kb() != before)
+            {
+                std::cout << "secure buffers unlocked a page used by another resource!!" << std::endl;
+
+                exit(1);
+            }
+
+            locking.deallocate(second, 64, 64);
+        }
+#endif
+
+        std::cout << "secure buffers passed!" << std::endl;
+    }
+
+    {
+        std::cout << std::endl << "Testing secure_erase" << std::endl;
+
+        for (const auto &size : {size_t(1), size_t(32), size_t(4099), size_t(1 << 20)})
+        {
+            auto buffer = std::vector<unsigned char>(size + 32, 0xff);
+
+            // wipe from an unaligned offset and make sure nothing outside the region is touched
+            secure_erase(buffer.data() + 3, size);
+
+            for (size_t i = 0; i < buffer.size(); ++i)
+            {
+                if ((i >= 3 && i < size + 3 && buffer[i] != 0) || ((i < 3 || i >= size + 3) && buffer[i] != 0xff))
+                {
+                    std::cout << "secure_erase MISMATCH at " << size << " bytes!!" << std::endl;
+
+                    exit(1);
+                }
+            }
+        }
+
+        std::cout << "secure_erase passed!" << std::endl;
+    }
+
+    {
+        std::cout << std::endl << "Testing svarint" << std::endl;
+
+        if (Serialization::encode_svarint<int64_t>(-1).size() != 1 || Serialization::encode_svarint<int64_t>(-64).size() != 1
+            || Serialization::encode_svarint<int64_t>(-65).size() != 2)
+        {
+            std::cout << "svarint size MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+
+        const auto values = std::vector<int64_t> {0,
+                                                  -1,
+                                                  1,
+                                                  -300,
+                                                  300,
+                                                  std::numeric_limits<int64_t>::min(),
+                                                  std::numeric_limits<int64_t>::max()};
+
+        Serialization::serializer_t writer;
+
+        writer.svarint(int8_t(-128));
+
+        writer.svarint(int16_t(-2));
+
+        writer.svarint(int32_t(std::numeric_limits<int32_t>::min()));
+
+        writer.svarint(values);
+
+        Serialization::deserializer_t reader(writer);
+
+        if (reader.svarint<int8_t>() != -128 || reader.svarint<int16_t>(true) != -2 || reader.svarint<int16_t>() != -2
+            || reader.svarint<int32_t>() != std::numeric_limits<int32_t>::min() || reader.svarintV<int64_t>() != values
+            || reader.unread_bytes() != 0)
+        {
+            std::cout << "svarint MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+
+        std::cout << "svarint passed!" << std::endl;
+    }
+
+    {
+        std::cout << std::endl << "Testing delta varint" << std::endl;
+
+        std::vector<uint64_t> values;
+
+        for (uint64_t i = 0, value = 1700000000; i < 1000; ++i, value += (i * 37) % 300)
+        {
+            values.push_back(value);
+        }
+
+        values.push_back(std::numeric_limits<uint64_t>::max());
+
+        Serialization::serializer_t writer, plain;
+
+        writer.delta_varint(values);
+
+        plain.varint(values);
+
+        Serialization::deserializer_t reader(writer);
+
+        if (writer.size() >= plain.size() || reader.delta_varintV<uint64_t>(true) != values
+            || reader.delta_varintV<uint64_t>() != values || reader.unread_bytes() != 0)
+        {
+            std::cout << "delta varint MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+
+        // rejected input must leave the writer untouched
+        writer.reset();
+
+        try
+        {
+            writer.delta_varint(std::vector<uint32_t> {1, 2, 5, 4});
+
+            std::cout << "delta varint unsorted MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+        catch (const std::invalid_argument &)
+        {
+        }
+
+        if (writer.size() != 0)
+        {
+            std::cout << "delta varint partial write MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+
+        // deltas that sum past the width of the type must be rejected
+        writer.reset();
+
+        writer.varint(2);
+
+        writer.varint(uint32_t(0xffffffff));
+
+        writer.varint(1);
+
+        try
+        {
+            Serialization::deserializer_t(writer).delta_varintV<uint32_t>();
+
+            std::cout << "delta varint overflow MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+        catch (const std::range_error &)
+        {
+        }
+
+        std::cout << "delta varint passed!" << std::endl;
+    }
+
+    {
+        std::cout << std::endl << "Testing bit packing" << std::endl;
+
+        std::vector<uint32_t> block(BITPACKING_BLOCK_SIZE), unpacked(BITPACKING_BLOCK_SIZE);
+
+        unsigned char packed[BITPACKING_BLOCK_SIZE * sizeof(uint32_t)];
+
+        for (uint8_t width = 0; width <= 32; ++width)
+        {
+            for (size_t i = 0; i < block.size(); ++i)
+            {
+                block[i] = uint32_t((i * 2654435761u) & (width == 32 ? 0xffffffff : (uint32_t(1) << width) - 1));
+            }
+
+            Serialization::BitPacking::pack(block.data(), width, packed);
+
+            Serialization::BitPacking::unpack(packed, width, unpacked.data());
+
+            if (unpacked != block)
+            {
+                std::cout << "bit packing width " << int(width) << " MISMATCH!!" << std::endl;
+
+                exit(1);
+            }
+        }
+
+        std::vector<uint64_t> values;
+
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            // a narrow block, a block spanning more than 32 bits, and a trailing partial block
+            values.push_back(i < 128 ? 1000000 + i % 17 : (i < 256 ? i * 0x100000000ull : i));
+        }
+
+        std::vector<uint16_t> narrow(300, 0xfff0);
+
+        narrow[5] = 0xffff;
+
+        Serialization::serializer_t writer, plain;
+
+        writer.bitpacked(values);
+
+        writer.bitpacked(narrow);
+
+        plain.varint(narrow);
+
+        Serialization::deserializer_t reader(writer);
+
+        if (reader.bitpackedV<uint64_t>(true) != values || reader.bitpackedV<uint64_t>() != values
+            || reader.bitpackedV<uint16_t>() != narrow || reader.unread_bytes() != 0)
+        {
+            std::cout << "bit packing MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+
+        writer.reset();
+
+        writer.bitpacked(narrow);
+
+        if (writer.size() >= plain.size() / 2)
+        {
+            std::cout << "bit packing size MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+
+        // a block whose minimum plus offsets exceed the type must be rejected
+        writer.reset();
+
+        writer.varint(BITPACKING_BLOCK_SIZE);
+
+        writer.varint(250);
+
+        writer.uint8(4);
+
+        writer.bytes(std::vector<unsigned char>(Serialization::BitPacking::packed_size(4), 0xff));
+
+        try
+        {
+            Serialization::deserializer_t(writer).bitpackedV<uint8_t>();
+
+            std::cout << "bit packing range MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+        catch (const std::range_error &)
+        {
+        }
+
+        // for a 64-bit type the minimum plus an offset wraps instead of exceeding the maximum
+        writer.reset();
+
+        writer.varint(BITPACKING_BLOCK_SIZE);
+
+        writer.varint(std::numeric_limits<uint64_t>::max());
+
+        writer.uint8(1);
+
+        writer.bytes(std::vector<unsigned char>(Serialization::BitPacking::packed_size(1), 0xff));
+
+        try
+        {
+            Serialization::deserializer_t(writer).bitpackedV<uint64_t>();
+
+            std::cout << "bit packing wrap MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+        catch (const std::range_error &)
+        {
+        }
+
+        std::cout << "bit packing passed!" << std::endl;
+    }
+
+    {
+        std::cout << std::endl << "Testing stream vbyte" << std::endl;
+
+        std::vector<uint32_t> values;
+
+        uint32_t state = 0x9e3779b9;
+
+        // lengths of one to four bytes in every combination, enough values for the vectorized path and a
+        // partial trailing control byte
+        for (size_t i = 0; i < 1003; ++i)
+        {
+            state ^= state << 13;
+
+            state ^= state >> 17;
+
+            state ^= state << 5;
+
+            values.push_back(state >> ((state & 3) * 8));
+        }
+
+        values.push_back(0);
+
+        values.push_back(0xffffffff);
+
+        Serialization::serializer_t writer;
+
+        writer.streamvbyte(values);
+
+        writer.streamvbyte(std::vector<uint16_t> {1, 300, 65535});
+
+        writer.streamvbyte(std::vector<uint32_t>());
+
+        // narrow values spanning several decode blocks
+        std::vector<uint16_t> narrow;
+
+        for (const auto &value : values)
+        {
+            narrow.push_back(uint16_t(value));
+        }
+
+        writer.streamvbyte(narrow);
+
+        Serialization::deserializer_t reader(writer);
+
+        if (reader.streamvbyteV<uint32_t>(true) != values || reader.streamvbyteV<uint32_t>() != values
+            || reader.streamvbyteV<uint16_t>() != std::vector<uint16_t> {1, 300, 65535}
+            || !reader.streamvbyteV<uint32_t>().empty() || reader.streamvbyteV<uint16_t>() != narrow
+            || reader.unread_bytes() != 0)
+        {
+            std::cout << "stream vbyte MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+
+        // values wider than the type and truncated data must be rejected
+        writer.reset();
+
+        writer.streamvbyte(std::vector<uint32_t> {65536});
+
+        try
+        {
+            Serialization::deserializer_t(writer).streamvbyteV<uint16_t>();
+
+            std::cout << "stream vbyte range MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+        catch (const std::range_error &)
+        {
+        }
+
+        writer.reset();
+
+        writer.streamvbyte(std::vector<uint32_t> {1, 2, 0xffffffff});
+
+        auto truncated = writer.vector();
+
+        truncated.pop_back();
+
+        try
+        {
+            Serialization::deserializer_t(truncated).streamvbyteV<uint32_t>();
+
+            std::cout << "stream vbyte truncation MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+        catch (const std::range_error &)
+        {
+        }
+
+        std::cout << "stream vbyte passed!" << std::endl;
+    }
+
+    {
+        std::cout << std::endl << "Testing wide varint" << std::endl;
+
+        const auto max128 = uint128_t(UINT64_MAX, UINT64_MAX);
+
+        const std::vector<uint128_t> narrow = {
+            0, 127, 128, 300, uint128_t(0, UINT64_MAX), uint128_t(1, 0), uint128_t(0x0123456789abcdef, 42), max128};
+
+        const std::vector<uint256_t> wide = {
+            0, 300, uint256_t(0, max128), uint256_t(1, 0), uint256_t(uint128_t(1, 0), 7), uint256_t(max128, max128)};
+
+        if (Serialization::encode_varint(uint128_t(300)).size() != 2
+            || Serialization::encode_varint(uint256_t(300)).size() != 2
+            || Serialization::encode_varint(max128).size() != 19
+            || Serialization::encode_varint(uint256_t(max128, max128)).size() != 37)
+        {
+            std::cout << "wide varint size MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+
+        Serialization::serializer_t writer;
+
+        writer.varint(narrow);
+
+        writer.varint(wide);
+
+        Serialization::deserializer_t reader(writer);
+
+        if (reader.varintV<uint128_t>() != narrow || reader.varintV<uint256_t>() != wide || reader.unread_bytes() != 0)
+        {
+            std::cout << "wide varint MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+
+        // a value wider than the type must be rejected rather than truncated
+        for (const auto &bytes : {Serialization::encode_varint(uint128_t(1, 0)), Serialization::encode_varint(300)})
+        {
+            try
+            {
+                if (bytes.size() == 2)
+                {
+                    Serialization::deserializer_t(bytes).varint<uint8_t>();
+                }
+                else
+                {
+                    Serialization::deserializer_t(bytes).varint<uint64_t>();
+                }
+
+                std::cout << "wide varint range MISMATCH!!" << std::endl;
+
+                exit(1);
+            }
+            catch (const std::range_error &)
+            {
+            }
+        }
+
+        std::cout << "wide varint passed!" << std::endl;
+    }
+
+    {
+        std::cout << std::endl << "Testing uint128 and uint256 limb order" << std::endl;
+
+        const auto value128 = uint128_t(0x0123456789abcdef, 0xfedcba9876543210);
+
+        const auto value256 = uint256_t(uint128_t(0x1111111111111111, 0x2222222222222222), value128);
+
+        // the limb order matches the object representation previously copied out on little endian hosts
+        const auto legacy = [](const auto &value, bool big_endian)
+        {
+            std::vector<unsigned char> result(sizeof(value));
+
+            std::memcpy(result.data(), &value, sizeof(value));
+
+            if (big_endian)
+            {
+                std::reverse(result.begin(), result.end());
+            }
+
+            return result;
+        };
+
+        Serialization::serializer_t writer;
+
+        writer.uint128(value128);
+
+        writer.uint128(value128, true);
+
+        writer.uint256(value256);
+
+        writer.uint256(value256, true);
+
+        auto expected = legacy(value128, false);
+
+        for (const auto &bytes : {legacy(value128, true), legacy(value256, false), legacy(value256, true)})
+        {
+            expected.insert(expected.end(), bytes.begin(), bytes.end());
+        }
+
+        const uint32_t probe = 1;
+
+        const auto little_endian = *reinterpret_cast<const unsigned char *>(&probe) == 1;
+
+        Serialization::deserializer_t reader(writer);
+
+        if ((little_endian && writer.vector() != expected) || reader.uint128(true) != value128
+            || reader.uint128() != value128 || reader.uint128(false, true) != value128 || reader.uint256() != value256
+            || reader.uint256(false, true) != value256 || reader.unread_bytes() != 0
+            || Serialization::unpack<uint256_t>(Serialization::pack(value256, true), 0, true) != value256)
+        {
+            std::cout << "limb order MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+
+        std::cout << "uint128 and uint256 limb order passed!" << std::endl;
+    }
+
+    {
+        std::cout << std::endl << "Testing fixed width arrays" << std::endl;
+
+        // enough values to exercise both the vectorized blocks and the trailing values
+        std::vector<uint16_t> values16;
+
+        std::vector<uint32_t> values32;
+
+        std::vector<uint64_t> values64;
+
+        for (uint64_t i = 0; i < 37; ++i)
+        {
+            const auto value = (i + 1) * 0x0102030405060708ull;
+
+            values16.push_back(uint16_t(value));
+
+            values32.push_back(uint32_t(value));
+
+            values64.push_back(value);
+        }
+
+        for (const auto &big_endian : {false, true})
+        {
+            Serialization::serializer_t writer, expected;
+
+            writer.uint16(values16, big_endian);
+
+            writer.uint32(values32, big_endian);
+
+            writer.uint64(values64, big_endian);
+
+            writer.uint64(values64.data(), 3, big_endian);
+
+            expected.varint(values16.size());
+
+            for (const auto &value : values16)
+            {
+                expected.uint16(value, big_endian);
+            }
+
+            expected.varint(values32.size());
+
+            for (const auto &value : values32)
+            {
+                expected.uint32(value, big_endian);
+            }
+
+            expected.varint(values64.size());
+
+            for (const auto &value : values64)
+            {
+                expected.uint64(value, big_endian);
+            }
+
+            for (size_t i = 0; i < 3; ++i)
+            {
+                expected.uint64(values64[i], big_endian);
+            }
+
+            Serialization::deserializer_t reader(writer);
+
+            uint64_t raw[3];
+
+            if (writer.vector() != expected.vector() || reader.uint16V(true, big_endian) != values16
+                || reader.uint16V(false, big_endian) != values16 || reader.uint32V(false, big_endian) != values32
+                || reader.uint64V(false, big_endian) != values64)
+            {
+                std::cout << "fixed width arrays MISMATCH!!" << std::endl;
+
+                exit(1);
+            }
+
+            reader.uint64(raw, 3, false, big_endian);
+
+            if (raw[0] != values64[0] || raw[2] != values64[2] || reader.unread_bytes() != 0)
+            {
+                std::cout << "fixed width raw arrays MISMATCH!!" << std::endl;
+
+                exit(1);
+            }
+        }
+
+        // a count that the remaining bytes cannot satisfy must be rejected
+        Serialization::serializer_t writer;
+
+        writer.varint(4);
+
+        writer.uint32(values32.data(), 3);
+
+        try
+        {
+            Serialization::deserializer_t(writer).uint32V();
+
+            std::cout << "fixed width arrays truncation MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+        catch (const std::range_error &)
+        {
+        }
+
+        std::cout << "fixed width arrays passed!" << std::endl;
+    }
+
+    {
+        std::cout << std::endl << "Testing bit streams" << std::endl;
+
+        std::vector<std::pair<uint64_t, uint8_t>> fields;
+
+        uint64_t state = 0x9e3779b97f4a7c15;
+
+        // widths of every size, crossing word boundaries at every alignment
+        for (size_t i = 0; i < 500; ++i)
+        {
+            state ^= state << 13;
+
+            state ^= state >> 7;
+
+            state ^= state << 17;
+
+            const auto width = uint8_t(i % 65);
+
+            fields.emplace_back(width == 64 ? state : state & ((uint64_t(1) << width) - 1), width);
+        }
+
+        std::vector<bool> flags(77);
+
+        for (size_t i = 0; i < flags.size(); ++i)
+        {
+            flags[i] = (i % 3) == 0;
+        }
+
+        Serialization::serializer_t writer;
+
+        {
+            Serialization::bit_writer_t bits(writer);
+
+            for (const auto &[value, width] : fields)
+            {
+                bits.bits(value, width);
+            }
+
+            bits.flag(true);
+        }
+
+        writer.uint8(0xaa);
+
+        writer.boolean(flags);
+
+        writer.uint8(0x55);
+
+        Serialization::deserializer_t reader(writer);
+
+        {
+            Serialization::bit_reader_t bits(reader);
+
+            for (const auto &[value, width] : fields)
+            {
+                if (bits.bits(width) != value)
+                {
+                    std::cout << "bit stream MISMATCH!!" << std::endl;
+
+                    exit(1);
+                }
+            }
+
+            if (!bits.flag())
+            {
+                std::cout << "bit stream flag MISMATCH!!" << std::endl;
+
+                exit(1);
+            }
+        }
+
+        if (reader.uint8() != 0xaa || reader.booleanV(true) != flags || reader.booleanV() != flags
+            || reader.uint8() != 0x55 || reader.unread_bytes() != 0)
+        {
+            std::cout << "bit stream alignment MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+
+        // 77 flags take ten bytes after their count
+        writer.reset();
+
+        writer.boolean(flags);
+
+        if (writer.size() != 11)
+        {
+            std::cout << "packed bool vector size MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+
+        try
+        {
+            Serialization::deserializer_t truncated(std::vector<unsigned char> {0x01, 0x02});
+
+            Serialization::bit_reader_t bits(truncated);
+
+            bits.bits(17);
+
+            std::cout << "bit stream truncation MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+        catch (const std::range_error &)
+        {
+        }
+
+        std::cout << "bit streams passed!" << std::endl;
+    }
+
+    {
+        std::cout << std::endl << "Testing pod dictionary encoding" << std::endl;
+
+        auto other = value;
+
+        other[0] ^= 0xff;
+
+        std::vector<value_t> values;
+
+        for (size_t i = 0; i < 100; ++i)
+        {
+            values.push_back((i % 7) == 3 ? other : value);
+        }
+
+        Serialization::serializer_t writer, plain;
+
+        writer.pod_dictionary(values);
+
+        plain.pod(values);
+
+        Serialization::deserializer_t reader(writer);
+
+        std::vector<value_t> dictionary;
+
+        std::vector<size_t> indices;
+
+        reader.pod_dictionaryV(dictionary, indices, true);
+
+        if (writer.size() >= plain.size() / 10 || dictionary.size() != 2 || dictionary[0] != value
+            || dictionary[1] != other || indices.size() != values.size() || indices[10] != 1
+            || reader.pod_dictionaryV<value_t>() != values || reader.unread_bytes() != 0)
+        {
+            std::cout << "pod dictionary MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+
+        // an index past the end of the dictionary must be rejected
+        writer.reset();
+
+        writer.pod(std::vector<value_t>(1, value));
+
+        writer.varint(std::vector<uint64_t> {0, 1});
+
+        try
+        {
+            Serialization::deserializer_t(writer).pod_dictionaryV<value_t>();
+
+            std::cout << "pod dictionary index MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+        catch (const std::range_error &)
+        {
+        }
+
+        std::cout << "pod dictionary encoding passed!" << std::endl;
+    }
+
+    {
+        std::cout << std::endl << "Testing pod prefix encoding" << std::endl;
+
+        // sorted keys that differ only in their two least significant (ie. first) bytes
+        std::vector<value_t> values;
+
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            auto key = value;
+
+            key[0] = (unsigned char)((i % 64) * 3);
+
+            key[1] = (unsigned char)(i / 64);
+
+            values.push_back(key);
+        }
+
+        std::sort(values.begin(), values.end());
+
+        Serialization::serializer_t writer, plain;
+
+        writer.pod_prefix(values, 8);
+
+        plain.pod(values);
+
+        Serialization::deserializer_t reader(writer);
+
+        if (writer.size() >= plain.size() / 5 || reader.pod_prefixV<value_t>(true) != values)
+        {
+            std::cout << "pod prefix MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+
+        const Serialization::pod_prefix_set_t<value_t> set(reader);
+
+        if (reader.unread_bytes() != 0 || set.size() != values.size() || set.values() != values
+            || set.at(0) != values[0] || set.at(437) != values[437] || set.at(999) != values[999])
+        {
+            std::cout << "pod prefix set MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            auto missing = values[i];
+
+            missing[0]++;
+
+            if (!set.contains(values[i]) || set.lower_bound(values[i]) != i || set.contains(missing)
+                || set.lower_bound(missing) != i + 1)
+            {
+                std::cout << "pod prefix search MISMATCH!!" << std::endl;
+
+                exit(1);
+            }
+        }
+
+        // unsorted values must be rejected before anything is written, leaving an enclosing frame intact
+        std::swap(values[1], values[2]);
+
+        writer.reset();
+
+        writer.begin_nested();
+
+        writer.uint8(0x42);
+
+        try
+        {
+            writer.pod_prefix(values);
+
+            std::cout << "pod prefix order MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+        catch (const std::invalid_argument &)
+        {
+        }
+
+        writer.end_nested();
+
+        if (writer.vector() != std::vector<unsigned char> {0x01, 0x42})
+        {
+            std::cout << "pod prefix order MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+
+        // values out of order only across a restart boundary must be rejected as well
+        std::swap(values[1], values[2]);
+
+        std::swap(values[15], values[16]);
+
+        try
+        {
+            writer.pod_prefix(values, 16);
+
+            std::cout << "pod prefix restart order MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+        catch (const std::invalid_argument &)
+        {
+        }
+
+        std::cout << "pod prefix encoding passed!" << std::endl;
+    }
+
+    {
+        std::cout << std::endl << "Testing columnar encoding" << std::endl;
+
+        struct record_t
+        {
+            uint32_t id;
+
+            int64_t delta;
+
+            bool active;
+
+            double score;
+
+            value_t key;
+        };
+
+        std::vector<record_t> records(300);
+
+        for (size_t i = 0; i < records.size(); ++i)
+        {
+            records[i].id = uint32_t(1000 + i);
+
+            records[i].delta = (i % 2 == 0) ? -int64_t(i) : int64_t(i * i);
+
+            records[i].active = (i % 3) == 0;
+
+            records[i].score = double(i) / 7;
+
+            records[i].key = value;
+
+            records[i].key[0] = (unsigned char)i;
+        }
+
+        Serialization::serializer_t writer;
+
+        writer.columns(
+            records, &record_t::id, &record_t::delta, &record_t::active, &record_t::score, &record_t::key);
+
+        Serialization::deserializer_t reader(writer);
+
+        const Serialization::column_reader_t columns(reader);
+
+        std::vector<record_t> decoded;
+
+        columns.records(
+            decoded, &record_t::id, &record_t::delta, &record_t::active, &record_t::score, &record_t::key);
+
+        bool match = reader.unread_bytes() == 0 && columns.size() == records.size() && columns.columns() == 5
+                     && decoded.size() == records.size();
+
+        for (size_t i = 0; match && i < records.size(); ++i)
+        {
+            match = decoded[i].id == records[i].id && decoded[i].delta == records[i].delta
+                    && decoded[i].active == records[i].active && decoded[i].score == records[i].score
+                    && decoded[i].key == records[i].key;
+        }
+
+        // decoding a single column must not require any of the others
+        const auto deltas = columns.column<int64_t>(1);
+
+        if (!match || deltas.size() != records.size() || deltas[7] != 49 || deltas[8] != -8)
+        {
+            std::cout << "columnar MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+
+        // a column decoded as a type of a different width must be rejected
+        try
+        {
+            columns.column<value_t>(3);
+
+            std::cout << "columnar width MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+        catch (const std::range_error &)
+        {
+        }
+
+        // a record count whose product with the field width wraps must still be rejected
+        writer.reset();
+
+        writer.varint((uint64_t(1) << 59) + 1);
+
+        writer.varint(1);
+
+        writer.varint(value.size());
+
+        writer.pod(value);
+
+        try
+        {
+            Serialization::deserializer_t hostile(writer);
+
+            Serialization::column_reader_t(hostile).column<value_t>(0);
+
+            std::cout << "columnar count MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+        catch (const std::range_error &)
+        {
+        }
+
+        // a hostile record count must be rejected before the records are allocated
+        writer.reset();
+
+        writer.varint(uint64_t(1) << 42);
+
+        writer.varint(1);
+
+        writer.varint(1);
+
+        writer.varint(0);
+
+        try
+        {
+            Serialization::deserializer_t hostile(writer);
+
+            Serialization::column_reader_t(hostile).records(decoded, &record_t::id);
+
+            std::cout << "columnar records MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+        catch (const std::range_error &)
+        {
+        }
+
+        std::cout << "columnar encoding passed!" << std::endl;
+    }
+
+    {
+        std::cout << std::endl << "Testing compression" << std::endl;
+
+        Serialization::serializer_t writer;
+
+        uint64_t state = 0x9e3779b97f4a7c15;
+
+        for (size_t i = 0; i < 5000; ++i)
+        {
+            state ^= state << 13;
+
+            state ^= state >> 7;
+
+            state ^= state << 17;
+
+            writer.varint(i);
+
+            writer.pod(value);
+
+            writer.uint64((i % 4 == 0) ? state : 0);
+
+            writer.hex(std::string((i % 12) * 2, 'a'));
+        }
+
+        // a small chunk size so that values straddle chunks
+        const auto compressed = writer.compressed(1000);
+
+        Serialization::rope_deserializer_t reader {std::vector<std::vector<unsigned char>>()};
+
+        Serialization::decompressor_t decompressor(reader);
+
+        // feed the stream in uneven pieces, as it might arrive from a socket
+        for (size_t offset = 0; offset < compressed.size(); offset += 7)
+        {
+            decompressor.write(compressed.data() + offset, std::min<size_t>(7, compressed.size() - offset));
+        }
+
+        bool match = compressed.size() < writer.size() / 2 && decompressor.finished() && reader.size() == writer.size();
+
+        for (size_t i = 0; match && i < 5000; ++i)
+        {
+            match = reader.varint<size_t>() == i && reader.pod<value_t>() == value;
+
+            reader.uint64();
+
+            reader.hex(i % 12);
+        }
+
+        // the decompressed bytes must be exactly those written, including those that do not compress
+        const auto expected = writer.vector();
+
+        reader.reset();
+
+        if (!match || reader.bytes(expected.size()) != expected)
+        {
+            std::cout << "compression MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+
+        // a chunk that does not decompress to its declared length must be rejected
+        auto corrupted = compressed;
+
+        corrupted[0] ^= 0x01;
+
+        try
+        {
+            Serialization::rope_deserializer_t sink {std::vector<std::vector<unsigned char>>()};
+
+            Serialization::decompressor_t(sink).write(corrupted);
+
+            std::cout << "compression corruption MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+        catch (const std::range_error &)
+        {
+        }
+
+        // headers must be rejected as soon as they are complete, whether they arrive whole or in pieces
+        const std::vector<std::vector<unsigned char>> headers = {
+            {0xe8, 0x03, 0x00, 0x00, 0xe8, 0x03, 0x00, 0x00}, // above the limit of the decompressor below
+            {0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00}, // more stored bytes than uncompressed bytes
+        };
+
+        for (const auto &header : headers)
+        {
+            for (size_t split = 1; split <= header.size(); split += header.size() - 1)
+            {
+                try
+                {
+                    Serialization::rope_deserializer_t sink {std::vector<std::vector<unsigned char>>()};
+
+                    Serialization::decompressor_t decompressor(sink, 500);
+
+                    decompressor.write(header.data(), split);
+
+                    decompressor.write(header.data() + split, header.size() - split);
+
+                    std::cout << "compression header MISMATCH!!" << std::endl;
+
+                    exit(1);
+                }
+                catch (const std::range_error &)
+                {
+                }
+            }
+        }
+
+        std::cout << "compression passed!" << std::endl;
+    }
+
+    {
+        std::cout << std::endl << "Testing sparse pod encoding" << std::endl;
+
+        const auto empty = value_t();
+
+        auto mostly_empty = empty;
+
+        mostly_empty[3] = 0x11;
+
+        mostly_empty[31] = 0x22;
+
+        Serialization::serializer_t writer;
+
+        writer.pod_sparse(empty);
+
+        writer.pod_sparse(mostly_empty);
+
+        writer.pod_sparse(value);
+
+        // marker only, marker + bitmap + two bytes, and marker + every byte
+        if (writer.size() != 1 + (1 + 4 + 2) + (1 + 32))
+        {
+            std::cout << "sparse pod size MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+
+        const std::vector<value_t> values {empty, mostly_empty, value, empty};
+
+        writer.pod_sparse(values);
+
+        Serialization::deserializer_t reader(writer);
+
+        if (reader.pod_sparse<value_t>() != empty || reader.pod_sparse<value_t>(true) != mostly_empty
+            || reader.pod_sparse<value_t>() != mostly_empty || reader.pod_sparse<value_t>() != value
+            || reader.pod_sparseV<value_t>() != values || reader.unread_bytes() != 0)
+        {
+            std::cout << "sparse pod MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+
+        // an unknown marker must be rejected
+        try
+        {
+            Serialization::deserializer_t({0x03}).pod_sparse<value_t>();
+
+            std::cout << "sparse pod marker MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+        catch (const std::range_error &)
+        {
+        }
+
+        // a truncated value, alone or within a vector, must leave the reader where it started
+        writer.reset();
+
+        writer.pod_sparse(std::vector<value_t> {empty, value});
+
+        auto truncated = writer.vector();
+
+        truncated.pop_back();
+
+        Serialization::deserializer_t short_reader(truncated);
+
+        for (size_t i = 0; i < 2; ++i)
+        {
+            try
+            {
+                if (i == 0)
+                {
+                    short_reader.pod_sparseV<value_t>();
+                }
+                else
+                {
+                    short_reader.reset(truncated.size() - 32);
+
+                    short_reader.pod_sparse<value_t>();
+                }
+
+                std::cout << "sparse pod truncation MISMATCH!!" << std::endl;
+
+                exit(1);
+            }
+            catch (const std::range_error &)
+            {
+            }
+
+            if (short_reader.unread_bytes() != (i == 0 ? truncated.size() : 32))
+            {
+                std::cout << "sparse pod reset MISMATCH!!" << std::endl;
+
+                exit(1);
+            }
+        }
+
+        std::cout << "sparse pod encoding passed!" << std::endl;
+    }
+
+    {
+        std::cout << std::endl << "Testing record streams" << std::endl;
+
+        std::stringstream file(std::ios::in | std::ios::out | std::ios::binary);
+
+        const auto make_record = [&](size_t i)
+        {
+            Serialization::serializer_t record;
+
+            record.varint(i);
+
+            record.bytes(std::vector<unsigned char>(i % 50, (unsigned char)i));
+
+            return record;
+        };
+
+        {
+            Serialization::record_stream_writer_t writer(file, 16, 8);
+
+            for (size_t i = 0; i < 1000; ++i)
+            {
+                writer.append(make_record(i));
+            }
+        }
+
+        const auto original = file.str();
+
+        // appending must continue after the existing data without rewriting it
+        {
+            Serialization::record_stream_writer_t writer(file, 16, 8);
+
+            for (size_t i = 1000; i < 1500; ++i)
+            {
+                writer.append(make_record(i));
+            }
+
+            writer.close();
+        }
+
+        Serialization::record_stream_reader_t reader(file);
+
+        bool match = file.str().compare(0, original.size(), original) == 0 && reader.size() == 1500
+                     && reader.boundaries().size() == 1500 / 16 + 1;
+
+        Serialization::deserializer_t record({});
+
+        for (size_t i = 0; match && i < 1500; ++i)
+        {
+            match = reader.next(record) && record.unread_data() == make_record(i).vector();
+        }
+
+        match = match && !reader.next(record);
+
+        // jumping straight to a record, including one that is not itself indexed
+        for (const auto &target : {size_t(0), size_t(777), size_t(1000), size_t(1499)})
+        {
+            reader.seek(target);
+
+            match = match && reader.position() == target && reader.next(record)
+                    && record.unread_data() == make_record(target).vector();
+        }
+
+        // splitting the stream at its index boundaries reads every record exactly once
+        const auto boundaries = reader.boundaries();
+
+        size_t total = 0;
+
+        for (size_t i = 0; match && i < boundaries.size(); ++i)
+        {
+            const auto stop = (i + 1 < boundaries.size()) ? boundaries[i + 1].record : reader.size();
+
+            reader.seek(boundaries[i].record);
+
+            while (match && reader.position() < stop)
+            {
+                match = reader.next(record) && record.unread_data() == make_record(reader.position() - 1).vector();
+
+                total++;
+            }
+        }
+
+        if (!match || total != 1500)
+        {
+            std::cout << "record stream MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+
+        // a stream that does not end in a footer must be rejected
+        try
+        {
+            std::stringstream truncated(
+                original.substr(0, original.size() - 1), std::ios::in | std::ios::out | std::ios::binary);
+
+            const Serialization::record_stream_reader_t check(truncated);
+
+            std::cout << "record stream footer MISMATCH!!" << std::endl;
+
+            exit(1);
+        }
+        catch (const std::range_error &)
+        {
+        }
+
+        std::cout << "record streams passed!" << std::endl;
+    }
 }